@@ -0,0 +1,231 @@
+#include "annexb_scanner.h"
+
+#include <cstring>
+
+// Define ANNEXB_SCANNER_PORTABLE to build only the portable version.
+#if defined(ANNEXB_SCANNER_PORTABLE)
+#elif defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANNEXB_SCANNER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ANNEXB_SCANNER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(ANNEXB_SCANNER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ANNEXB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ANNEXB_TARGET_AVX2
+#endif
+
+namespace {
+
+typedef size_t (*FindStartCodeFunction)(const uint8_t*, size_t, size_t);
+
+inline unsigned CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+#if !defined(ANNEXB_SCANNER_X86) && !defined(ANNEXB_SCANNER_NEON)
+
+// Portable version: skips 8 candidate positions at a time while none of
+// them holds a zero byte.
+size_t FindStartCodeSWAR(const uint8_t* data, size_t size, size_t from) {
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  size_t i = from;
+  while (i + 10 <= size) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    if (((word - ones) & ~word & highs) == 0) {
+      i += 8;
+      continue;
+    }
+    for (size_t end = i + 8; i < end; i++) {
+      if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+        return i;
+      }
+    }
+  }
+  return FindAnnexBStartCodeScalar(data, size, i);
+}
+
+#endif
+
+#if defined(ANNEXB_SCANNER_X86)
+
+// Compares 16 candidate positions at once: bit j of the mask is set if
+// data[i + j], data[i + j + 1], data[i + j + 2] is 00 00 01. The three loads
+// overlap, so start codes crossing a block boundary are found too.
+size_t FindStartCodeSSE2(const uint8_t* data, size_t size, size_t from) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  size_t i = from;
+  for (; i + 18 <= size; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i a_zero = _mm_cmpeq_epi8(a, zero);
+    // Most blocks of compressed video have no zero byte at all
+    if (_mm_movemask_epi8(a_zero) == 0) {
+      continue;
+    }
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+    __m128i match = _mm_and_si128(_mm_and_si128(a_zero, _mm_cmpeq_epi8(b, zero)),
+                                  _mm_cmpeq_epi8(c, one));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask);
+    }
+  }
+  return FindAnnexBStartCodeScalar(data, size, i);
+}
+
+// Same as the SSE2 version, 32 positions at a time
+ANNEXB_TARGET_AVX2
+size_t FindStartCodeAVX2(const uint8_t* data, size_t size, size_t from) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi8(1);
+  size_t i = from;
+  for (; i + 34 <= size; i += 32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i a_zero = _mm256_cmpeq_epi8(a, zero);
+    if (_mm256_movemask_epi8(a_zero) == 0) {
+      continue;
+    }
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+    __m256i match = _mm256_and_si256(_mm256_and_si256(a_zero, _mm256_cmpeq_epi8(b, zero)),
+                                     _mm256_cmpeq_epi8(c, one));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask);
+    }
+  }
+  return FindStartCodeSSE2(data, size, i);
+}
+
+bool CpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // OSXSAVE and AVX, and the OS saves the YMM registers
+  const int osxsave_avx = (1 << 27) | (1 << 28);
+  if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // ANNEXB_SCANNER_X86
+
+#if defined(ANNEXB_SCANNER_NEON)
+
+size_t FindStartCodeNEON(const uint8_t* data, size_t size, size_t from) {
+  const uint8x16_t zero = vdupq_n_u8(0);
+  const uint8x16_t one = vdupq_n_u8(1);
+  size_t i = from;
+  for (; i + 18 <= size; i += 16) {
+    uint8x16_t a_zero = vceqq_u8(vld1q_u8(data + i), zero);
+    if (vmaxvq_u8(a_zero) == 0) {
+      continue;
+    }
+    uint8x16_t match = vandq_u8(vandq_u8(a_zero, vceqq_u8(vld1q_u8(data + i + 1), zero)),
+                                vceqq_u8(vld1q_u8(data + i + 2), one));
+    if (vmaxvq_u8(match) != 0) {
+      return FindAnnexBStartCodeScalar(data, i + 18, i);
+    }
+  }
+  return FindAnnexBStartCodeScalar(data, size, i);
+}
+
+#endif  // ANNEXB_SCANNER_NEON
+
+struct Implementation {
+  FindStartCodeFunction function;
+  const char* name;
+};
+
+Implementation SelectImplementation() {
+#if defined(ANNEXB_SCANNER_X86)
+  if (CpuSupportsAVX2()) {
+    return Implementation{FindStartCodeAVX2, "avx2"};
+  }
+  return Implementation{FindStartCodeSSE2, "sse2"};
+#elif defined(ANNEXB_SCANNER_NEON)
+  return Implementation{FindStartCodeNEON, "neon"};
+#else
+  return Implementation{FindStartCodeSWAR, "swar"};
+#endif
+}
+
+const Implementation& GetImplementation() {
+  static const Implementation implementation = SelectImplementation();
+  return implementation;
+}
+
+}  // namespace
+
+size_t FindAnnexBStartCodeScalar(const uint8_t* data, size_t size, size_t from) {
+  for (size_t i = from; i + 3 <= size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+      return i;
+    }
+  }
+  return size;
+}
+
+size_t FindAnnexBStartCode(const uint8_t* data, size_t size, size_t from) {
+  if (!data || from >= size) {
+    return size;
+  }
+  return GetImplementation().function(data, size, from);
+}
+
+const char* AnnexBScannerImplementation() {
+  return GetImplementation().name;
+}
+
+bool NextAnnexBNalu(const uint8_t* data, size_t size, size_t* position,
+                    const uint8_t** nalu, size_t* nalu_size) {
+  while (*position < size) {
+    size_t begin = *position;
+    size_t next = FindAnnexBStartCode(data, size, begin);
+    if (next == begin) {
+      begin += 3;
+      next = FindAnnexBStartCode(data, size, begin);
+    }
+    *position = next;
+
+    // Zero bytes before a start code belong to it, not to this NAL unit
+    size_t end = next;
+    while (end > begin && data[end - 1] == 0) {
+      end--;
+    }
+    if (end > begin) {
+      *nalu = data + begin;
+      *nalu_size = end - begin;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,33 @@
+#ifndef ANNEXB_SCANNER_H_
+#define ANNEXB_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Annex-B byte stream scanning (ITU-T H.264, Annex B).
+//
+// Emulation prevention guarantees that 00 00 01 never occurs inside a NAL
+// unit, so every match is a start code; a preceding 00 is the zero_byte of a
+// 4-byte start code or trailing_zero_8bits, and is not part of the NAL unit
+// before it. 00 00 03 sequences are left alone.
+
+// Returns the offset of the first 00 00 01 at or after `from`, or `size` if
+// there is none. Uses the fastest implementation the CPU supports, picked on
+// first use: AVX2 or SSE2 on x86, NEON on ARM64, and otherwise a portable
+// version testing 8 bytes at a time.
+size_t FindAnnexBStartCode(const uint8_t* data, size_t size, size_t from = 0);
+
+// Byte-by-byte reference implementation
+size_t FindAnnexBStartCodeScalar(const uint8_t* data, size_t size, size_t from = 0);
+
+// Name of the implementation FindAnnexBStartCode() uses
+const char* AnnexBScannerImplementation();
+
+// Returns the next NAL unit at or after `*position`, without its start code
+// or trailing zero bytes, and moves `*position` past it. Data before the
+// first start code counts as a NAL unit, so a buffer without start codes is
+// one NAL unit. Returns false at the end of the buffer.
+bool NextAnnexBNalu(const uint8_t* data, size_t size, size_t* position,
+                    const uint8_t** nalu, size_t* nalu_size);
+
+#endif  // ANNEXB_SCANNER_H_
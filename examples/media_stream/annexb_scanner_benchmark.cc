@@ -0,0 +1,90 @@
+// Microbenchmark of the Annex-B start code scanner against the scalar
+// version, on a synthetic high-bitrate stream. Built as the
+// annexb_scanner_benchmark target; configure with
+// -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "annexb_scanner.h"
+
+namespace {
+
+typedef size_t (*FindFunction)(const uint8_t*, size_t, size_t);
+
+// NAL units of `nalu_size` bytes of random data with emulation prevention
+// applied, each behind a 4-byte start code
+std::vector<uint8_t> MakeStream(size_t size, size_t nalu_size) {
+  std::mt19937 rng(42);
+  std::vector<uint8_t> stream;
+  stream.reserve(size + nalu_size);
+  while (stream.size() < size) {
+    stream.insert(stream.end(), {0x00, 0x00, 0x00, 0x01, 0x41});
+    int zeros = 0;
+    for (size_t i = 0; i < nalu_size; i++) {
+      uint8_t byte = static_cast<uint8_t>(rng());
+      if (zeros == 2 && byte <= 3) {
+        stream.push_back(0x03);
+        zeros = 0;
+      }
+      stream.push_back(byte);
+      zeros = byte == 0 ? zeros + 1 : 0;
+    }
+    // A NAL unit never ends with a zero byte
+    stream.push_back(0x80);
+  }
+  return stream;
+}
+
+size_t CountStartCodes(FindFunction find, const std::vector<uint8_t>& stream) {
+  size_t count = 0;
+  size_t position = find(stream.data(), stream.size(), 0);
+  while (position < stream.size()) {
+    count++;
+    position = find(stream.data(), stream.size(), position + 3);
+  }
+  return count;
+}
+
+size_t FindDispatched(const uint8_t* data, size_t size, size_t from) {
+  return FindAnnexBStartCode(data, size, from);
+}
+
+void Run(const char* name, FindFunction find, const std::vector<uint8_t>& stream,
+         int iterations) {
+  size_t count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    count += CountStartCodes(find, stream);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double bytes = static_cast<double>(stream.size()) * iterations;
+  std::cout << name << ": " << bytes / elapsed.count() / 1e9 << " GB/s ("
+            << count / iterations << " start codes)" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  const size_t kStreamSize = 64 * 1024 * 1024;
+  const int kIterations = 10;
+
+  std::cout << "Dispatched implementation: " << AnnexBScannerImplementation()
+            << std::endl;
+  // Large slices, as in high-bitrate streams, and small ones
+  for (size_t nalu_size : {size_t{200000}, size_t{1200}}) {
+    std::vector<uint8_t> stream = MakeStream(kStreamSize, nalu_size);
+    std::cout << "NAL units of " << nalu_size << " bytes" << std::endl;
+    if (CountStartCodes(FindAnnexBStartCodeScalar, stream) !=
+        CountStartCodes(FindDispatched, stream)) {
+      std::cerr << "Implementations disagree" << std::endl;
+      return 1;
+    }
+    Run("  scalar", FindAnnexBStartCodeScalar, stream, kIterations);
+    Run("  simd  ", FindDispatched, stream, kIterations);
+  }
+  return 0;
+}
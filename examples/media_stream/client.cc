@@ -1,7 +1,7 @@
 #include "web_transport.h"
 #include <iostream>
 
-#include "rtp_packet.h"
+#include "rtp_packet_view.h"
 #include "h264_packet.h"
 #include "h264_rtp_packetizer.h"
 #include "h264_rtp_depacketizer.h"
@@ -35,16 +35,17 @@ int main() {
 
         // Register the datagram read callback, capturing the depacketizer and the output file.
         session->onDatagramRead([h264_depacketizer, output_file](std::vector<uint8_t> data) {
-            RTPPacket rtp_packet;
-            if (!rtp_packet.Unmarshal(data.data(), data.size())) {
+            // Parsed in place; the payload points into `data`.
+            RtpPacketView rtp_packet;
+            if (!rtp_packet.Parse(data.data(), data.size())) {
                 std::cerr << "Failed to parse RTP packet" << std::endl;
                 return;
             }
     
-            std::cout << "Received rtp packet size: " << rtp_packet.GetPayloadSize() << std::endl;
+            std::cout << "Received rtp packet size: " << rtp_packet.GetPayload().size() << std::endl;
     
             std::vector<uint8_t> h264_payload;
-            if (!h264_depacketizer->Unmarshal(rtp_packet.GetPayload(), rtp_packet.GetPayloadSize(), &h264_payload)) {
+            if (!h264_depacketizer->Unmarshal(rtp_packet.GetPayload().data(), rtp_packet.GetPayload().size(), &h264_payload)) {
                 std::cerr << "Failed to depacketize H264 payload (possibly due to lost RTP packets)" << std::endl;
                 return;
             }
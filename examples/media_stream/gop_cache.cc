@@ -0,0 +1,113 @@
+#include "gop_cache.h"
+
+#include "rtp_packet_view.h"
+
+namespace {
+
+// Parameter set packets kept after the one carrying the SPS.
+const size_t kMaxParameterSetPackets = 8;
+
+// Whether a single NALU or STAP-A payload carries a NALU of `type`.
+bool ContainsNalu(const uint8_t* payload, size_t payload_size, uint8_t type) {
+  if (payload_size < 1) {
+    return false;
+  }
+  uint8_t nalu_type = payload[0] & NALU_TYPE_BITMASK;
+  if (nalu_type != STAPA_NALU_TYPE) {
+    return nalu_type == type;
+  }
+
+  size_t offset = STAPA_HEADER_SIZE;
+  while (offset + STAPA_NALU_LENGTH_SIZE < payload_size) {
+    size_t nalu_size = (static_cast<size_t>(payload[offset]) << 8) |
+                       payload[offset + 1];
+    offset += STAPA_NALU_LENGTH_SIZE;
+    if ((payload[offset] & NALU_TYPE_BITMASK) == type) {
+      return true;
+    }
+    offset += nalu_size;
+  }
+  return false;
+}
+
+}  // namespace
+
+GopCache::GopCache(Codec codec, size_t max_packets, size_t max_bytes)
+    : codec_(codec),
+      max_packets_(max_packets),
+      max_bytes_(max_bytes),
+      gop_bytes_(0),
+      have_key_frame_(false),
+      key_frame_timestamp_(0) {}
+
+bool GopCache::IsKeyFrame(const uint8_t* payload, size_t payload_size) {
+  if (codec_ == CODEC_H264) {
+    return h264_.IsKeyFrame(payload, payload_size);
+  }
+  return vp8_.Unmarshal(payload, payload_size, &scratch_) && vp8_.IsKeyFrame();
+}
+
+bool GopCache::Push(const web_transport::SharedBuffer& packet) {
+  RtpPacketView rtp_packet;
+  if (!rtp_packet.Parse(packet.data(), packet.size())) {
+    return false;
+  }
+  const uint8_t* payload = rtp_packet.GetPayload().data();
+  size_t payload_size = rtp_packet.GetPayload().size();
+  bool key_frame = IsKeyFrame(payload, payload_size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (codec_ == CODEC_H264) {
+    if (ContainsNalu(payload, payload_size, SPS_NALU_TYPE)) {
+      parameter_sets_.clear();
+      parameter_sets_.push_back(packet);
+    } else if (ContainsNalu(payload, payload_size, PPS_NALU_TYPE) &&
+               !parameter_sets_.empty() &&
+               parameter_sets_.size() < kMaxParameterSetPackets) {
+      parameter_sets_.push_back(packet);
+    }
+  }
+
+  // Later slices or partitions of the same keyframe share its timestamp.
+  if (key_frame && (!have_key_frame_ ||
+                    rtp_packet.GetTimestamp() != key_frame_timestamp_)) {
+    ResetGop();
+    have_key_frame_ = true;
+    key_frame_timestamp_ = rtp_packet.GetTimestamp();
+  }
+  if (!have_key_frame_) {
+    return true;
+  }
+
+  gop_.push_back(packet);
+  gop_bytes_ += packet.size();
+  if (gop_.size() > max_packets_ || gop_bytes_ > max_bytes_) {
+    // A GOP with its tail cut off would leave a gap before the live feed.
+    ResetGop();
+  }
+  return true;
+}
+
+std::vector<web_transport::SharedBuffer> GopCache::Snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<web_transport::SharedBuffer> packets;
+  if (gop_.empty()) {
+    return packets;
+  }
+  packets.reserve(parameter_sets_.size() + gop_.size());
+  packets.insert(packets.end(), parameter_sets_.begin(), parameter_sets_.end());
+  packets.insert(packets.end(), gop_.begin(), gop_.end());
+  return packets;
+}
+
+void GopCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  parameter_sets_.clear();
+  ResetGop();
+}
+
+void GopCache::ResetGop() {
+  gop_.clear();
+  gop_bytes_ = 0;
+  have_key_frame_ = false;
+}
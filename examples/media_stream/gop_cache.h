@@ -0,0 +1,62 @@
+#ifndef GOP_CACHE_H_
+#define GOP_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "h264_rtp_depacketizer.h"
+#include "vp8_rtp_depacketizer.h"
+#include "web_transport.h"
+
+// GopCache keeps the RTP packets of the current group of pictures, from the
+// last keyframe on, so that a new subscriber can be sent a decodable picture
+// right away instead of waiting for the next keyframe. For H264 the latest
+// SPS/PPS packets are kept too, since they usually arrive just before the
+// IDR. Push() is called by the one thread feeding the cache; Snapshot() may
+// be called from any thread.
+class GopCache {
+ public:
+  enum Codec {
+    CODEC_H264,
+    CODEC_VP8,
+  };
+
+  // A GOP over either limit is dropped, and caching resumes at the next
+  // keyframe.
+  explicit GopCache(Codec codec, size_t max_packets = 4096,
+                    size_t max_bytes = 8 * 1024 * 1024);
+
+  // Adds a packet of the live feed. Returns false if it is not valid RTP.
+  bool Push(const web_transport::SharedBuffer& packet);
+
+  // Packets to replay to a new subscriber, in order: parameter sets, then
+  // the current GOP. Empty until the first keyframe. The buffers are shared
+  // with the cache, not copied.
+  std::vector<web_transport::SharedBuffer> Snapshot() const;
+
+  // Drops everything, e.g. when the source changes.
+  void Clear();
+
+ private:
+  bool IsKeyFrame(const uint8_t* payload, size_t payload_size);
+  void ResetGop();
+
+  Codec codec_;
+  size_t max_packets_;
+  size_t max_bytes_;
+  H264Depacketizer h264_;
+  VP8Depacketizer vp8_;
+  std::vector<uint8_t> scratch_;
+
+  mutable std::mutex mutex_;
+  // Starts at the latest packet carrying an SPS.
+  std::vector<web_transport::SharedBuffer> parameter_sets_;
+  std::vector<web_transport::SharedBuffer> gop_;
+  size_t gop_bytes_;
+  bool have_key_frame_;
+  uint32_t key_frame_timestamp_;
+};
+
+#endif  // GOP_CACHE_H_
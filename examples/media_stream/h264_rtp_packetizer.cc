@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include "annexb_scanner.h"
 #include "h264_packet.h"
 
 // NALU start codes
@@ -49,12 +50,80 @@ void H264Payloader::ClearSPSPPS() {
   pps_nalu_.clear();
 }
 
-std::vector<std::vector<uint8_t>> H264Payloader::CreateFUAPackets(
-    uint16_t mtu, const uint8_t* nalu, size_t nalu_size) {
-  std::vector<std::vector<uint8_t>> packets;
-  
+// PacketSink receives the packets EmitNALUs() produces
+class H264Payloader::PacketSink {
+ public:
+  virtual ~PacketSink() {}
+
+  // Returns `size` bytes to write the next packet into, or nullptr if
+  // there is no room left
+  virtual uint8_t* NewPacket(size_t size) = 0;
+};
+
+namespace {
+
+// Collects each packet into its own vector
+class VectorSink : public H264Payloader::PacketSink {
+ public:
+  explicit VectorSink(std::vector<std::vector<uint8_t>>* payloads)
+      : payloads_(payloads) {}
+
+  uint8_t* NewPacket(size_t size) override {
+    payloads_->emplace_back(size);
+    return payloads_->back().data();
+  }
+
+ private:
+  std::vector<std::vector<uint8_t>>* payloads_;
+};
+
+// Writes packets back to back into an arena
+class ArenaSink : public H264Payloader::PacketSink {
+ public:
+  ArenaSink(H264PacketArena* arena, size_t headroom)
+      : arena_(arena), headroom_(headroom) {}
+
+  uint8_t* NewPacket(size_t size) override {
+    return arena_->Allocate(headroom_, size);
+  }
+
+ private:
+  H264PacketArena* arena_;
+  size_t headroom_;
+};
+
+}  // namespace
+
+H264PacketArena::H264PacketArena(uint8_t* buffer, size_t capacity,
+                                 H264PayloadFragment* fragments,
+                                 size_t max_fragments)
+    : buffer_(buffer),
+      capacity_(capacity),
+      used_(0),
+      fragments_(fragments),
+      max_fragments_(max_fragments),
+      fragment_count_(0) {}
+
+void H264PacketArena::Reset() {
+  used_ = 0;
+  fragment_count_ = 0;
+}
+
+uint8_t* H264PacketArena::Allocate(size_t headroom, size_t size) {
+  if (fragment_count_ == max_fragments_ ||
+      capacity_ - used_ < headroom + size) {
+    return nullptr;
+  }
+  size_t offset = used_ + headroom;
+  fragments_[fragment_count_++] = H264PayloadFragment{offset, size};
+  used_ = offset + size;
+  return buffer_ + offset;
+}
+
+bool H264Payloader::CreateFUAPackets(uint16_t mtu, const uint8_t* nalu,
+                                     size_t nalu_size, PacketSink* sink) {
   if (nalu_size <= 1) {
-    return packets;  // Invalid NALU
+    return true;  // Invalid NALU
   }
   
   // The FU-A header size
@@ -82,7 +151,10 @@ std::vector<std::vector<uint8_t>> H264Payloader::CreateFUAPackets(
     size_t current_fragment_size = std::min(max_fragment_size, data_remaining);
     
     // Create packet for this fragment
-    std::vector<uint8_t> packet(fua_header_size + current_fragment_size);
+    uint8_t* packet = sink->NewPacket(fua_header_size + current_fragment_size);
+    if (!packet) {
+      return false;
+    }
     
     // FU indicator - uses the original NALU NRI value but with FU-A type (28)
     packet[0] = nalu_ref_idc | FUA_NALU_TYPE;
@@ -100,141 +172,102 @@ std::vector<std::vector<uint8_t>> H264Payloader::CreateFUAPackets(
     }
     
     // Copy the fragment data
-    std::memcpy(packet.data() + fua_header_size, 
+    std::memcpy(packet + fua_header_size, 
                nalu + data_index, 
                current_fragment_size);
     
-    packets.push_back(std::move(packet));
-    
     data_remaining -= current_fragment_size;
     data_index += current_fragment_size;
   }
   
-  return packets;
+  return true;
+}
+
+bool H264Payloader::EmitNALUs(const uint8_t* payload, size_t payload_size,
+                              PacketSink* sink, uint16_t mtu) {
+  size_t position = 0;
+  const uint8_t* nalu;
+  size_t nalu_size;
+  while (NextAnnexBNalu(payload, payload_size, &position, &nalu, &nalu_size)) {
+    if (!EmitNALU(nalu, nalu_size, sink, mtu)) {
+      return false;
+    }
+  }
+  return true;
 }
 
-void H264Payloader::EmitNALUs(const uint8_t* payload, size_t payload_size, 
-                             std::vector<std::vector<uint8_t>>& payloads, uint16_t mtu) {
-  // First, try to find a 3-byte or 4-byte start code
-  size_t start = 0;
+bool H264Payloader::EmitNALU(const uint8_t* nalu, size_t nalu_size,
+                             PacketSink* sink, uint16_t mtu) {
+  // Check NALU type
+  uint8_t nalu_type = nalu[0] & NALU_TYPE_BITMASK;
   
-  while (start < payload_size) {
-    // Find the next start code
-    size_t next_start = payload_size;
-    
-    // Look for 3-byte start code
-    for (size_t i = start + 3; i < payload_size; i++) {
-      if (i + 2 < payload_size && 
-          payload[i] == 0 && payload[i+1] == 0 && payload[i+2] == 1) {
-        next_start = i;
-        break;
+  // Skip AUD and filler NALUs
+  if (nalu_type == AUD_NALU_TYPE || nalu_type == FILLER_NALU_TYPE) {
+    // Skip this NALU
+  } 
+  // Store SPS/PPS if not disabled
+  else if (!disable_stapa_ && nalu_type == SPS_NALU_TYPE) {
+    SetSPS(nalu, nalu_size);
+  }
+  else if (!disable_stapa_ && nalu_type == PPS_NALU_TYPE) {
+    SetPPS(nalu, nalu_size);
+  } 
+  // For other NALUs, check if we need to create a STAP-A packet with SPS/PPS
+  else if (!disable_stapa_ && !sps_nalu_.empty() && !pps_nalu_.empty()) {
+    // Calculate size of a STAP-A packet with SPS+PPS+current NALU
+    size_t stapa_size = 1 +  // STAP-A header
+                      2 + sps_nalu_.size() +  // Size + SPS
+                      2 + pps_nalu_.size() +  // Size + PPS
+                      2 + nalu_size;         // Size + current NALU
+                      
+    if (stapa_size <= mtu) {
+      // We can fit SPS+PPS+NALU in one STAP-A packet
+      uint8_t* stapa_packet = sink->NewPacket(stapa_size);
+      if (!stapa_packet) {
+        return false;
       }
       
-      // Also check for 4-byte start code
-      if (i + 3 < payload_size &&
-          payload[i-1] == 0 && payload[i] == 0 && payload[i+1] == 0 && payload[i+2] == 1) {
-        next_start = i - 1;
-        break;
-      }
-    }
-    
-    // Determine the offset from the start code to the actual NALU
-    size_t offset = 3;  // Default for 3-byte start code
-    
-    // Check if we have a 3-byte or 4-byte start code
-    if (start + 3 < payload_size && 
-        payload[start] == 0 && payload[start+1] == 0 && 
-        payload[start+2] == 0 && payload[start+3] == 1) {
-      offset = 4;  // 4-byte start code
-    } else if (start + 2 < payload_size &&
-              payload[start] == 0 && payload[start+1] == 0 && payload[start+2] == 1) {
-      offset = 3;  // 3-byte start code
-    } else if (start == 0) {
-      // No start code at the beginning, treat the entire buffer as one NALU
-      offset = 0;
-    }
-    
-    // Extract the NALU from start+offset to next_start
-    const uint8_t* nalu = payload + start + offset;
-    size_t nalu_size = next_start - (start + offset);
-    
-    if (nalu_size > 0) {
-      // Check NALU type
-      uint8_t nalu_type = nalu[0] & NALU_TYPE_BITMASK;
+      // STAP-A header
+      stapa_packet[0] = 0x78;  // STAP-A NALU type (24) + NRI bits
       
-      // Skip AUD and filler NALUs
-      if (nalu_type == AUD_NALU_TYPE || nalu_type == FILLER_NALU_TYPE) {
-        // Skip this NALU
-      } 
-      // Store SPS/PPS if not disabled
-      else if (!disable_stapa_ && nalu_type == SPS_NALU_TYPE) {
-        SetSPS(nalu, nalu_size);
-      }
-      else if (!disable_stapa_ && nalu_type == PPS_NALU_TYPE) {
-        SetPPS(nalu, nalu_size);
-      } 
-      // For other NALUs, check if we need to create a STAP-A packet with SPS/PPS
-      else if (!disable_stapa_ && !sps_nalu_.empty() && !pps_nalu_.empty()) {
-        // Calculate size of a STAP-A packet with SPS+PPS+current NALU
-        size_t stapa_size = 1 +  // STAP-A header
-                          2 + sps_nalu_.size() +  // Size + SPS
-                          2 + pps_nalu_.size() +  // Size + PPS
-                          2 + nalu_size;         // Size + current NALU
-                          
-        if (stapa_size <= mtu) {
-          // We can fit SPS+PPS+NALU in one STAP-A packet
-          std::vector<uint8_t> stapa_packet(stapa_size);
-          
-          // STAP-A header
-          stapa_packet[0] = 0x78;  // STAP-A NALU type (24) + NRI bits
-          
-          // Add SPS size and data
-          size_t offset = 1;
-          stapa_packet[offset++] = (sps_nalu_.size() >> 8) & 0xFF;
-          stapa_packet[offset++] = sps_nalu_.size() & 0xFF;
-          std::memcpy(stapa_packet.data() + offset, sps_nalu_.data(), sps_nalu_.size());
-          offset += sps_nalu_.size();
-          
-          // Add PPS size and data
-          stapa_packet[offset++] = (pps_nalu_.size() >> 8) & 0xFF;
-          stapa_packet[offset++] = pps_nalu_.size() & 0xFF;
-          std::memcpy(stapa_packet.data() + offset, pps_nalu_.data(), pps_nalu_.size());
-          offset += pps_nalu_.size();
-          
-          // Add current NALU size and data
-          stapa_packet[offset++] = (nalu_size >> 8) & 0xFF;
-          stapa_packet[offset++] = nalu_size & 0xFF;
-          std::memcpy(stapa_packet.data() + offset, nalu, nalu_size);
-          
-          payloads.push_back(std::move(stapa_packet));
-          
-          // Clear SPS/PPS after use
-          sps_nalu_.clear();
-          pps_nalu_.clear();
-          
-          // Skip to the next NALU
-          start = next_start;
-          continue;
-        }
-      }
+      // Add SPS size and data
+      size_t offset = 1;
+      stapa_packet[offset++] = (sps_nalu_.size() >> 8) & 0xFF;
+      stapa_packet[offset++] = sps_nalu_.size() & 0xFF;
+      std::memcpy(stapa_packet + offset, sps_nalu_.data(), sps_nalu_.size());
+      offset += sps_nalu_.size();
       
-      // If the NALU fits in a single packet, send it as is
-      if (nalu_size <= mtu) {
-        std::vector<uint8_t> packet(nalu_size);
-        std::memcpy(packet.data(), nalu, nalu_size);
-        payloads.push_back(std::move(packet));
-      } else {
-        // NALU is too big, fragment it using FU-A
-        auto fragments = CreateFUAPackets(mtu, nalu, nalu_size);
-        payloads.insert(payloads.end(), 
-                      std::make_move_iterator(fragments.begin()), 
-                      std::make_move_iterator(fragments.end()));
-      }
+      // Add PPS size and data
+      stapa_packet[offset++] = (pps_nalu_.size() >> 8) & 0xFF;
+      stapa_packet[offset++] = pps_nalu_.size() & 0xFF;
+      std::memcpy(stapa_packet + offset, pps_nalu_.data(), pps_nalu_.size());
+      offset += pps_nalu_.size();
+      
+      // Add current NALU size and data
+      stapa_packet[offset++] = (nalu_size >> 8) & 0xFF;
+      stapa_packet[offset++] = nalu_size & 0xFF;
+      std::memcpy(stapa_packet + offset, nalu, nalu_size);
+      
+      // Clear SPS/PPS after use
+      sps_nalu_.clear();
+      pps_nalu_.clear();
+      
+      return true;
     }
-    
-    // Move to next NALU
-    start = next_start;
   }
+  
+  // If the NALU fits in a single packet, send it as is
+  if (nalu_size <= mtu) {
+    uint8_t* packet = sink->NewPacket(nalu_size);
+    if (!packet) {
+      return false;
+    }
+    std::memcpy(packet, nalu, nalu_size);
+  } else if (!CreateFUAPackets(mtu, nalu, nalu_size, sink)) {
+    // NALU is too big, fragment it using FU-A
+    return false;
+  }
+  return true;
 }
 
 std::vector<std::vector<uint8_t>> H264Payloader::Payload(uint16_t mtu, 
@@ -247,7 +280,23 @@ std::vector<std::vector<uint8_t>> H264Payloader::Payload(uint16_t mtu,
   }
   
   // Process the H264 stream and emit NALUs
-  EmitNALUs(payload, payload_size, payloads, mtu);
+  VectorSink sink(&payloads);
+  EmitNALUs(payload, payload_size, &sink, mtu);
   
   return payloads;
-}
\ No newline at end of file
+}
+
+bool H264Payloader::PayloadInto(uint16_t mtu, const uint8_t* payload,
+                                size_t payload_size, size_t headroom,
+                                H264PacketArena* arena) {
+  if (!arena) {
+    return false;
+  }
+  arena->Reset();
+  if (!payload || payload_size == 0) {
+    return true;
+  }
+
+  ArenaSink sink(arena, headroom);
+  return EmitNALUs(payload, payload_size, &sink, mtu);
+}
@@ -1,9 +1,49 @@
 #ifndef H264_RTP_PACKETIZER_H_
 #define H264_RTP_PACKETIZER_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
+// A packet written by H264Payloader::PayloadInto(). Its payload starts at
+// `offset` in the arena; the headroom requested for the RTP header
+// precedes it.
+struct H264PayloadFragment {
+  size_t offset;
+  size_t size;
+};
+
+// H264PacketArena is caller-owned memory that PayloadInto() writes packets
+// into, back to back. Both the bytes and the fragment table are supplied by
+// the caller, so packetizing allocates nothing; reuse one arena per frame.
+class H264PacketArena {
+ public:
+  H264PacketArena(uint8_t* buffer, size_t capacity,
+                  H264PayloadFragment* fragments, size_t max_fragments);
+
+  // Forgets the packets written so far, keeping the memory
+  void Reset();
+
+  uint8_t* Data() const { return buffer_; }
+  size_t Size() const { return used_; }
+  size_t FragmentCount() const { return fragment_count_; }
+  const H264PayloadFragment& Fragment(size_t index) const { return fragments_[index]; }
+  // Start of a fragment's payload, e.g. for RtpWriter::WriteHeaderBefore()
+  uint8_t* Payload(size_t index) const { return buffer_ + fragments_[index].offset; }
+
+  // Reserves `headroom` bytes and then `size` bytes for a new fragment, and
+  // returns the latter, or nullptr if the arena is full
+  uint8_t* Allocate(size_t headroom, size_t size);
+
+ private:
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t used_;
+  H264PayloadFragment* fragments_;
+  size_t max_fragments_;
+  size_t fragment_count_;
+};
+
 // H264Payloader payloads H264 packets
 class H264Payloader {
  public:
@@ -31,16 +71,28 @@ class H264Payloader {
   // mtu is the maximum size each fragment can have
   std::vector<std::vector<uint8_t>> Payload(uint16_t mtu, const uint8_t* payload, size_t payload_size);
 
+  // Payload without allocating: the packets are written into `arena`, which
+  // is reset first, each with `headroom` bytes in front of it for the RTP
+  // header. Returns false if the arena ran out of room or fragment slots;
+  // the packets written up to then stay in the arena.
+  bool PayloadInto(uint16_t mtu, const uint8_t* payload, size_t payload_size,
+                   size_t headroom, H264PacketArena* arena);
+
+  class PacketSink;
+
  private:
   bool is_avc_;
   bool disable_stapa_;
   std::vector<uint8_t> sps_nalu_;
   std::vector<uint8_t> pps_nalu_;
   
-  // Helper methods
-  std::vector<std::vector<uint8_t>> CreateFUAPackets(uint16_t mtu, const uint8_t* nalu, size_t nalu_size);
-  void EmitNALUs(const uint8_t* payload, size_t payload_size, 
-                 std::vector<std::vector<uint8_t>>& payloads, uint16_t mtu);
+  // Helper methods; both return false once `sink` is out of room
+  bool CreateFUAPackets(uint16_t mtu, const uint8_t* nalu, size_t nalu_size,
+                        PacketSink* sink);
+  bool EmitNALUs(const uint8_t* payload, size_t payload_size,
+                 PacketSink* sink, uint16_t mtu);
+  bool EmitNALU(const uint8_t* nalu, size_t nalu_size, PacketSink* sink,
+                uint16_t mtu);
 };
 
 #endif  // H264_RTP_PACKETIZER_H_
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "rtp_packet_view.h"
+
+namespace {
+
+const size_t RTP_HEADER_SIZE = 12;
+const size_t RTP_EXTENSION_HEADER_SIZE = 4;
+
+bool IsRFC8285Profile(uint16_t profile, bool* two_byte) {
+  if (profile == RTP_ONE_BYTE_EXTENSION_PROFILE) {
+    *two_byte = false;
+    return true;
+  }
+  if ((profile & 0xFFF0) == RTP_TWO_BYTE_EXTENSION_PROFILE) {
+    *two_byte = true;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+RtpPacketView::RtpPacketView()
+    : header_size_(0),
+      extension_profile_(0),
+      padding_size_(0) {}
+
+bool RtpPacketView::Parse(const uint8_t* buffer, size_t buffer_size) {
+  *this = RtpPacketView();
+  if (!buffer || buffer_size < RTP_HEADER_SIZE || (buffer[0] >> 6) != 2) {
+    return false;
+  }
+
+  size_t header_size = RTP_HEADER_SIZE + (buffer[0] & 0x0F) * 4;
+  if (buffer_size < header_size) {
+    return false;
+  }
+
+  uint16_t extension_profile = 0;
+  std::span<const uint8_t> extension_data;
+  if (buffer[0] & 0x10) {
+    if (buffer_size < header_size + RTP_EXTENSION_HEADER_SIZE) {
+      return false;
+    }
+    extension_profile = static_cast<uint16_t>((buffer[header_size] << 8) |
+                                              buffer[header_size + 1]);
+    // Length is in 32-bit words
+    size_t extension_size = ((static_cast<size_t>(buffer[header_size + 2]) << 8) |
+                             buffer[header_size + 3]) * 4;
+    header_size += RTP_EXTENSION_HEADER_SIZE;
+    if (buffer_size < header_size + extension_size) {
+      return false;
+    }
+    extension_data = std::span<const uint8_t>(buffer + header_size, extension_size);
+    header_size += extension_size;
+
+    RtpExtensionReader reader(extension_profile, extension_data);
+    RtpHeaderExtension extension;
+    while (reader.Next(&extension)) {
+    }
+    if (reader.HasError()) {
+      return false;
+    }
+  }
+
+  size_t payload_size = buffer_size - header_size;
+  uint8_t padding_size = 0;
+  if (buffer[0] & 0x20) {
+    padding_size = buffer[buffer_size - 1];
+    if (padding_size == 0 || padding_size > payload_size) {
+      return false;
+    }
+    payload_size -= padding_size;
+  }
+
+  packet_ = std::span<const uint8_t>(buffer, buffer_size);
+  header_size_ = header_size;
+  extension_profile_ = extension_profile;
+  extension_data_ = extension_data;
+  padding_size_ = padding_size;
+  payload_ = std::span<const uint8_t>(buffer + header_size, payload_size);
+  return true;
+}
+
+bool RtpPacketView::FindExtension(uint8_t id, std::span<const uint8_t>* value) const {
+  RtpExtensionReader reader(extension_profile_, extension_data_);
+  RtpHeaderExtension extension;
+  while (reader.Next(&extension)) {
+    if (extension.id == id) {
+      *value = extension.value;
+      return true;
+    }
+  }
+  return false;
+}
+
+RtpExtensionReader::RtpExtensionReader(uint16_t profile,
+                                       std::span<const uint8_t> data)
+    : two_byte_(false),
+      data_(data),
+      offset_(0),
+      error_(false) {
+  if (!IsRFC8285Profile(profile, &two_byte_)) {
+    data_ = std::span<const uint8_t>();
+  }
+}
+
+bool RtpExtensionReader::Next(RtpHeaderExtension* extension) {
+  while (offset_ < data_.size()) {
+    uint8_t first = data_[offset_];
+    // Padding between elements; in the one-byte form any ID 0 byte
+    if (first == 0 || (!two_byte_ && (first >> 4) == 0)) {
+      offset_++;
+      continue;
+    }
+
+    size_t length;
+    size_t value_offset;
+    if (two_byte_) {
+      if (offset_ + 2 > data_.size()) {
+        error_ = true;
+        return false;
+      }
+      extension->id = first;
+      length = data_[offset_ + 1];
+      value_offset = offset_ + 2;
+    } else {
+      extension->id = first >> 4;
+      // ID 15 stops processing of the whole block (RFC 8285, section 4.2)
+      if (extension->id == 15) {
+        offset_ = data_.size();
+        return false;
+      }
+      length = (first & 0x0F) + 1;
+      value_offset = offset_ + 1;
+    }
+
+    if (value_offset + length > data_.size()) {
+      error_ = true;
+      return false;
+    }
+    extension->value = data_.subspan(value_offset, length);
+    offset_ = value_offset + length;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,97 @@
+#ifndef RTP_PACKET_VIEW_H_
+#define RTP_PACKET_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// RFC 8285 header extension profiles
+const uint16_t RTP_ONE_BYTE_EXTENSION_PROFILE = 0xBEDE;
+const uint16_t RTP_TWO_BYTE_EXTENSION_PROFILE = 0x1000;  // low 4 bits: appbits
+
+// One RFC 8285 header extension element
+struct RtpHeaderExtension {
+  uint8_t id;
+  std::span<const uint8_t> value;
+};
+
+// RtpPacketView parses an RTP packet (RFC 3550) in place. Nothing is copied
+// or allocated: the payload, CSRCs and extensions are spans into the parsed
+// buffer, which must outlive the view.
+class RtpPacketView {
+ public:
+  RtpPacketView();
+
+  // Validates the header, CSRC list, extension and padding. Returns false,
+  // leaving the view empty, if the packet is malformed.
+  bool Parse(const uint8_t* buffer, size_t buffer_size);
+  bool IsValid() const { return !packet_.empty(); }
+
+  uint8_t GetVersion() const { return packet_[0] >> 6; }
+  bool GetPadding() const { return (packet_[0] & 0x20) != 0; }
+  bool GetExtension() const { return (packet_[0] & 0x10) != 0; }
+  bool GetMarker() const { return (packet_[1] & 0x80) != 0; }
+  uint8_t GetPayloadType() const { return packet_[1] & 0x7F; }
+  uint16_t GetSequenceNumber() const { return ReadU16(2); }
+  uint32_t GetTimestamp() const { return ReadU32(4); }
+  uint32_t GetSSRC() const { return ReadU32(8); }
+
+  uint8_t GetCSRCCount() const { return packet_[0] & 0x0F; }
+  uint32_t GetCSRC(size_t index) const { return ReadU32(12 + index * 4); }
+
+  // Extension profile (e.g. 0xBEDE) and data, without the 4-byte header.
+  uint16_t GetExtensionProfile() const { return extension_profile_; }
+  std::span<const uint8_t> GetExtensionData() const { return extension_data_; }
+
+  // Finds an RFC 8285 extension element by id. Returns false if the packet
+  // has none with that id, or uses another extension profile.
+  bool FindExtension(uint8_t id, std::span<const uint8_t>* value) const;
+
+  // Header size, including CSRCs and extension.
+  size_t GetHeaderSize() const { return header_size_; }
+  std::span<const uint8_t> GetPayload() const { return payload_; }
+  uint8_t GetPaddingSize() const { return padding_size_; }
+  std::span<const uint8_t> GetPacket() const { return packet_; }
+
+ private:
+  uint16_t ReadU16(size_t offset) const {
+    return static_cast<uint16_t>((packet_[offset] << 8) | packet_[offset + 1]);
+  }
+  uint32_t ReadU32(size_t offset) const {
+    return (static_cast<uint32_t>(packet_[offset]) << 24) |
+           (static_cast<uint32_t>(packet_[offset + 1]) << 16) |
+           (static_cast<uint32_t>(packet_[offset + 2]) << 8) |
+           packet_[offset + 3];
+  }
+
+  std::span<const uint8_t> packet_;
+  size_t header_size_;
+  uint16_t extension_profile_;
+  std::span<const uint8_t> extension_data_;
+  uint8_t padding_size_;
+  std::span<const uint8_t> payload_;
+};
+
+// RtpExtensionReader walks the RFC 8285 elements of an extension block,
+// skipping padding. Usage:
+//
+//   RtpExtensionReader reader(view.GetExtensionProfile(), view.GetExtensionData());
+//   RtpHeaderExtension extension;
+//   while (reader.Next(&extension)) { ... }
+class RtpExtensionReader {
+ public:
+  RtpExtensionReader(uint16_t profile, std::span<const uint8_t> data);
+
+  // False once the elements are exhausted, or at a malformed element.
+  bool Next(RtpHeaderExtension* extension);
+  // True if the walk stopped at a malformed element rather than the end.
+  bool HasError() const { return error_; }
+
+ private:
+  bool two_byte_;
+  std::span<const uint8_t> data_;
+  size_t offset_;
+  bool error_;
+};
+
+#endif  // RTP_PACKET_VIEW_H_
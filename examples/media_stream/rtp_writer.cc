@@ -0,0 +1,192 @@
+#include "rtp_writer.h"
+
+#include <cstring>
+
+#include "rtp_packet_view.h"
+
+namespace {
+
+const size_t RTP_HEADER_SIZE = 12;
+const size_t RTP_EXTENSION_HEADER_SIZE = 4;
+
+void WriteU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value >> 8);
+  out[1] = static_cast<uint8_t>(value);
+}
+
+void WriteU32(uint8_t* out, uint32_t value) {
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+}
+
+}  // namespace
+
+RtpWriter::RtpWriter()
+    : csrc_count_(0),
+      extension_count_(0) {}
+
+bool RtpWriter::SetCSRCs(const uint32_t* csrcs, size_t count) {
+  if (count > MAX_CSRCS || (count > 0 && !csrcs)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    csrcs_[i] = csrcs[i];
+  }
+  csrc_count_ = count;
+  return true;
+}
+
+bool RtpWriter::AddExtension(uint8_t id, const uint8_t* value, size_t size) {
+  // Id 0 is padding; values are at most 255 bytes even in the two-byte form
+  if (id == 0 || size > 255 || (size > 0 && !value) ||
+      extension_count_ == MAX_EXTENSIONS) {
+    return false;
+  }
+  extensions_[extension_count_++] = Extension{id, value, size};
+  return true;
+}
+
+bool RtpWriter::UseTwoByteExtensions() const {
+  for (size_t i = 0; i < extension_count_; i++) {
+    const Extension& extension = extensions_[i];
+    if (extension.id > 14 || extension.size == 0 || extension.size > 16) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t RtpWriter::ExtensionDataSize() const {
+  size_t element_header_size = UseTwoByteExtensions() ? 2 : 1;
+  size_t size = 0;
+  for (size_t i = 0; i < extension_count_; i++) {
+    size += element_header_size + extensions_[i].size;
+  }
+  return (size + 3) & ~size_t{3};
+}
+
+size_t RtpWriter::HeaderSize() const {
+  size_t size = RTP_HEADER_SIZE + csrc_count_ * 4;
+  if (extension_count_ > 0) {
+    size += RTP_EXTENSION_HEADER_SIZE + ExtensionDataSize();
+  }
+  return size;
+}
+
+size_t RtpWriter::WriteHeader(uint8_t* buffer, size_t capacity) const {
+  size_t header_size = HeaderSize();
+  if (!buffer || capacity < header_size) {
+    return 0;
+  }
+
+  buffer[0] = static_cast<uint8_t>(0x80 | (extension_count_ > 0 ? 0x10 : 0) |
+                                   csrc_count_);
+  buffer[1] = static_cast<uint8_t>((header_.marker ? 0x80 : 0) |
+                                   (header_.payload_type & 0x7F));
+  WriteU16(buffer + 2, header_.sequence_number);
+  WriteU32(buffer + 4, header_.timestamp);
+  WriteU32(buffer + 8, header_.ssrc);
+  uint8_t* out = buffer + RTP_HEADER_SIZE;
+  for (size_t i = 0; i < csrc_count_; i++) {
+    WriteU32(out, csrcs_[i]);
+    out += 4;
+  }
+
+  if (extension_count_ == 0) {
+    return header_size;
+  }
+
+  bool two_byte = UseTwoByteExtensions();
+  size_t data_size = ExtensionDataSize();
+  WriteU16(out, two_byte ? RTP_TWO_BYTE_EXTENSION_PROFILE : RTP_ONE_BYTE_EXTENSION_PROFILE);
+  WriteU16(out + 2, static_cast<uint16_t>(data_size / 4));
+  out += RTP_EXTENSION_HEADER_SIZE;
+  uint8_t* data_end = out + data_size;
+  for (size_t i = 0; i < extension_count_; i++) {
+    const Extension& extension = extensions_[i];
+    if (two_byte) {
+      *out++ = extension.id;
+      *out++ = static_cast<uint8_t>(extension.size);
+    } else {
+      *out++ = static_cast<uint8_t>((extension.id << 4) | (extension.size - 1));
+    }
+    if (extension.size > 0) {
+      std::memcpy(out, extension.value, extension.size);
+      out += extension.size;
+    }
+  }
+  // Padding to the 32-bit boundary
+  while (out < data_end) {
+    *out++ = 0;
+  }
+  return header_size;
+}
+
+uint8_t* RtpWriter::WriteHeaderBefore(uint8_t* payload, size_t headroom) const {
+  size_t header_size = HeaderSize();
+  if (!payload || headroom < header_size) {
+    return nullptr;
+  }
+  uint8_t* packet = payload - header_size;
+  WriteHeader(packet, header_size);
+  return packet;
+}
+
+bool RtpWriter::RewriteMarker(uint8_t* packet, size_t packet_size, bool marker) {
+  if (!packet || packet_size < RTP_HEADER_SIZE) {
+    return false;
+  }
+  packet[1] = static_cast<uint8_t>((packet[1] & 0x7F) | (marker ? 0x80 : 0));
+  return true;
+}
+
+bool RtpWriter::RewritePayloadType(uint8_t* packet, size_t packet_size,
+                                   uint8_t payload_type) {
+  if (!packet || packet_size < RTP_HEADER_SIZE) {
+    return false;
+  }
+  packet[1] = static_cast<uint8_t>((packet[1] & 0x80) | (payload_type & 0x7F));
+  return true;
+}
+
+bool RtpWriter::RewriteSequenceNumber(uint8_t* packet, size_t packet_size,
+                                      uint16_t sequence_number) {
+  if (!packet || packet_size < RTP_HEADER_SIZE) {
+    return false;
+  }
+  WriteU16(packet + 2, sequence_number);
+  return true;
+}
+
+bool RtpWriter::RewriteTimestamp(uint8_t* packet, size_t packet_size,
+                                 uint32_t timestamp) {
+  if (!packet || packet_size < RTP_HEADER_SIZE) {
+    return false;
+  }
+  WriteU32(packet + 4, timestamp);
+  return true;
+}
+
+bool RtpWriter::RewriteSSRC(uint8_t* packet, size_t packet_size, uint32_t ssrc) {
+  if (!packet || packet_size < RTP_HEADER_SIZE) {
+    return false;
+  }
+  WriteU32(packet + 8, ssrc);
+  return true;
+}
+
+bool RtpWriter::RewriteExtension(uint8_t* packet, size_t packet_size, uint8_t id,
+                                 const uint8_t* value, size_t size) {
+  RtpPacketView view;
+  std::span<const uint8_t> current;
+  if (!view.Parse(packet, packet_size) || !view.FindExtension(id, &current) ||
+      current.size() != size) {
+    return false;
+  }
+  if (size > 0) {
+    std::memcpy(packet + (current.data() - packet), value, size);
+  }
+  return true;
+}
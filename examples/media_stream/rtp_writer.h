@@ -0,0 +1,85 @@
+#ifndef RTP_WRITER_H_
+#define RTP_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed RTP header fields written by RtpWriter
+struct RtpHeader {
+  bool marker = false;
+  uint8_t payload_type = 0;
+  uint16_t sequence_number = 0;
+  uint32_t timestamp = 0;
+  uint32_t ssrc = 0;
+};
+
+// RtpWriter serializes RTP headers (RFC 3550) with RFC 8285 header
+// extensions straight into caller-provided memory. It never allocates.
+//
+// To send a payload without copying it, produce the payload with
+// HeaderSize() bytes of headroom in front of it and call WriteHeaderBefore():
+// the header lands in the headroom and header plus payload form the packet.
+//
+// The static Rewrite functions patch fields of an existing packet in place,
+// e.g. to remap the SSRC and sequence numbers of relayed packets.
+class RtpWriter {
+ public:
+  static const size_t MAX_CSRCS = 15;
+  static const size_t MAX_EXTENSIONS = 16;
+
+  RtpWriter();
+
+  void SetHeader(const RtpHeader& header) { header_ = header; }
+  const RtpHeader& GetHeader() const { return header_; }
+
+  // Contributing sources; at most MAX_CSRCS.
+  bool SetCSRCs(const uint32_t* csrcs, size_t count);
+
+  // Adds a header extension element. The value is not copied and must stay
+  // valid until the header is written. Ids 1-14 with 1-16 byte values use
+  // the one-byte form; anything else switches the whole block to two-byte.
+  bool AddExtension(uint8_t id, const uint8_t* value, size_t size);
+  void ClearExtensions() { extension_count_ = 0; }
+
+  // Bytes WriteHeader() writes with the current settings.
+  size_t HeaderSize() const;
+
+  // Writes the header at the start of `buffer`. Returns its size, or 0 if
+  // it does not fit in `capacity`.
+  size_t WriteHeader(uint8_t* buffer, size_t capacity) const;
+
+  // Writes the header into the `headroom` bytes before `payload`. Returns
+  // the start of the packet, or nullptr if the headroom is too small.
+  uint8_t* WriteHeaderBefore(uint8_t* payload, size_t headroom) const;
+
+  // In-place rewrites of a complete packet. Return false if it is too short
+  // to hold the field.
+  static bool RewriteMarker(uint8_t* packet, size_t packet_size, bool marker);
+  static bool RewritePayloadType(uint8_t* packet, size_t packet_size, uint8_t payload_type);
+  static bool RewriteSequenceNumber(uint8_t* packet, size_t packet_size, uint16_t sequence_number);
+  static bool RewriteTimestamp(uint8_t* packet, size_t packet_size, uint32_t timestamp);
+  static bool RewriteSSRC(uint8_t* packet, size_t packet_size, uint32_t ssrc);
+  // Overwrites the value of an existing extension element of the same size.
+  static bool RewriteExtension(uint8_t* packet, size_t packet_size, uint8_t id,
+                               const uint8_t* value, size_t size);
+
+ private:
+  struct Extension {
+    uint8_t id;
+    const uint8_t* value;
+    size_t size;
+  };
+
+  bool UseTwoByteExtensions() const;
+  // Size of the extension elements, padded to 32 bits, without the 4-byte
+  // extension header.
+  size_t ExtensionDataSize() const;
+
+  RtpHeader header_;
+  uint32_t csrcs_[MAX_CSRCS];
+  size_t csrc_count_;
+  Extension extensions_[MAX_EXTENSIONS];
+  size_t extension_count_;
+};
+
+#endif  // RTP_WRITER_H_
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <thread>
 
 // Platform-specific includes and definitions
 #ifdef _WIN32
@@ -16,6 +17,20 @@
 #endif
 
 #include "web_transport.h" // Include your custom WebTransport header
+#include "gop_cache.h"
+#include "h264_packet.h"
+#include "h264_rtp_depacketizer.h"
+#include "h264_rtp_packetizer.h"
+#include "rtp_packet_view.h"
+#include "rtp_writer.h"
+
+// SSRC of the relayed stream, whatever the encoder uses.
+const uint32_t kRelaySsrc = 0x57540001;
+
+// Largest RTP payload sent to sessions. A datagram has to fit in one QUIC
+// packet, which the RTP from the encoder (up to 1472 bytes from ffmpeg)
+// need not.
+const uint16_t kMaxRtpPayloadSize = 1100;
 
 int main() {
 
@@ -44,65 +59,28 @@ int main() {
         return 1;
     }
 
-    // Set the socket to non-blocking mode
-    #ifdef _WIN32
-        u_long mode = 1;
-        ioctlsocket(udp_socket, FIONBIO, &mode);
-    #else
-        int flags = fcntl(udp_socket, F_GETFL, 0);
-        if (flags < 0) flags = 0;
-        fcntl(udp_socket, F_SETFL, flags | O_NONBLOCK);
-    #endif
-
     // ----- Initialize WebTransport Server -----
     web_transport::Server server("0.0.0.0", 443);
     server.setCertFile("/root/libwebtransport/ssls/fullchain.pem");
     server.setKeyFile("/root/libwebtransport/ssls/privkey.pem");
 
 
-    // Set up a session callback. Capture udp_socket by value so it is available in the lambda.
-    server.onSession([udp_socket](void* session_ptr, const std::string& path) {
+    // Packets since the last keyframe, replayed to each new session so it
+    // can decode a picture within a round trip instead of waiting for the
+    // next IDR.
+    GopCache gop_cache(GopCache::CODEC_H264);
+
+    // Every session gets the RTP packets as datagrams from the "rtp" channel.
+    server.onSession([&server, &gop_cache](void* session_ptr, const std::string& path) {
         auto* session = static_cast<web_transport::ServerSession*>(session_ptr);
         std::cout << "New session on path: " << path << std::endl;
 
-
-        // don't miss rtp resend packets poll super
-        session->setInterval(1, [session, udp_socket]() {
-            // Prepare a buffer sized to typical MTU
-            std::vector<uint8_t> buffer(65500);
-            sockaddr_in src_addr;
-            #ifdef _WIN32
-                int addr_len = sizeof(src_addr);
-            #else
-                socklen_t addr_len = sizeof(src_addr);
-            #endif
-
-            // Attempt a non-blocking read from the UDP socket.
-            int bytes_received = recvfrom(
-                udp_socket,
-                reinterpret_cast<char*>(buffer.data()),
-                static_cast<int>(buffer.size()),
-                0,
-                reinterpret_cast<sockaddr*>(&src_addr),
-                &addr_len
-            );
-
-            // Only process the data if we received any.
-            if (bytes_received > 0) {
-
-                std::cout << bytes_received << std::endl;
-
-                // Resize !!!!!
-                // Resize buffer to only include valid data.
-                buffer.resize(bytes_received);
-                session->sendDatagram(buffer);
-            }
-
-            // If no data is available, recvfrom will return -1 (or SOCKET_ERROR on Windows)
-            // with an error indicating that the operation would block.
-        });
-
-
+        // Replay first, then join the live feed. Both happen on the server
+        // thread, so no packet falls in between; a few may arrive twice.
+        for (const web_transport::SharedBuffer& packet : gop_cache.Snapshot()) {
+            session->sendDatagram(packet);
+        }
+        server.subscribe("rtp", session_ptr);
         return true;
     });
 
@@ -118,7 +96,108 @@ int main() {
 
 
 
-    server.initialize();
+    if (!server.initialize()) {
+        std::cerr << "Failed to initialize server." << std::endl;
+        return 1;
+    }
+
+    // One reader publishes each RTP packet once, however many sessions
+    // there are; the server fans it out on its own thread. Sessions see one
+    // stream even when the encoder restarts with a new SSRC and sequence
+    // base. Packets that fit a datagram only need those two fields patched
+    // in place in the receive buffer. Larger ones, and FU-A fragments, are
+    // depacketized and packetized again at kMaxRtpPayloadSize into an arena
+    // reused for every NALU: the packetizer leaves room in front of each
+    // fragment and the RTP header is written there, so nothing is copied
+    // until the packet becomes a SharedBuffer.
+    std::thread reader([&server, &gop_cache, udp_socket]() {
+        std::vector<uint8_t> buffer(65500);
+        H264Depacketizer depacketizer;
+        H264Payloader payloader;
+        RtpWriter writer;
+        std::vector<uint8_t> nalus;
+        std::vector<uint8_t> arena_buffer(1 << 20);
+        std::vector<H264PayloadFragment> fragments(1024);
+        H264PacketArena arena(arena_buffer.data(), arena_buffer.size(),
+                              fragments.data(), fragments.size());
+        bool have_source = false;
+        uint32_t source_ssrc = 0;
+        uint16_t expected_source_sequence = 0;
+        // Last relayed sequence number. It advances by one per packet sent
+        // and by the encoder's gaps, so that loss stays visible.
+        uint16_t sequence_number = 0;
+        while (true) {
+            int bytes_received = recvfrom(
+                udp_socket,
+                reinterpret_cast<char*>(buffer.data()),
+                static_cast<int>(buffer.size()),
+                0,
+                nullptr,
+                nullptr
+            );
+            if (bytes_received <= 0) {
+                continue;
+            }
+            RtpPacketView rtp_packet;
+            if (!rtp_packet.Parse(buffer.data(), bytes_received)) {
+                continue;
+            }
+            uint16_t source_sequence = rtp_packet.GetSequenceNumber();
+            if (have_source && rtp_packet.GetSSRC() == source_ssrc) {
+                // A late packet looks like a gap of more than half the
+                // sequence space; it must not move the numbers on.
+                uint16_t gap = static_cast<uint16_t>(source_sequence - expected_source_sequence);
+                if (gap < 0x8000) {
+                    sequence_number = static_cast<uint16_t>(sequence_number + gap);
+                }
+            } else {
+                have_source = true;
+                source_ssrc = rtp_packet.GetSSRC();
+            }
+            expected_source_sequence = static_cast<uint16_t>(source_sequence + 1);
+
+            std::span<const uint8_t> payload = rtp_packet.GetPayload();
+            bool fragmented = !payload.empty() && (payload[0] & NALU_TYPE_BITMASK) == FUA_NALU_TYPE;
+            if (!fragmented && payload.size() <= kMaxRtpPayloadSize) {
+                ++sequence_number;
+                RtpWriter::RewriteSSRC(buffer.data(), bytes_received, kRelaySsrc);
+                RtpWriter::RewriteSequenceNumber(buffer.data(), bytes_received, sequence_number);
+
+                web_transport::SharedBuffer packet(buffer.data(), bytes_received);
+                gop_cache.Push(packet);
+                server.publish("rtp", packet);
+                continue;
+            }
+
+            // Empty until the last fragment of a fragmented NALU.
+            if (!depacketizer.Unmarshal(payload.data(), payload.size(), &nalus) || nalus.empty()) {
+                continue;
+            }
+            RtpHeader header;
+            header.payload_type = rtp_packet.GetPayloadType();
+            header.timestamp = rtp_packet.GetTimestamp();
+            header.ssrc = kRelaySsrc;
+            writer.SetHeader(header);
+            size_t header_size = writer.HeaderSize();
+            if (!payloader.PayloadInto(kMaxRtpPayloadSize, nalus.data(), nalus.size(),
+                                       header_size, &arena)) {
+                std::cerr << "Dropped a NALU too large for the packet arena" << std::endl;
+                continue;
+            }
+
+            for (size_t i = 0; i < arena.FragmentCount(); ++i) {
+                header.sequence_number = ++sequence_number;
+                header.marker = rtp_packet.GetMarker() && i + 1 == arena.FragmentCount();
+                writer.SetHeader(header);
+                uint8_t* start = writer.WriteHeaderBefore(arena.Payload(i), header_size);
+                web_transport::SharedBuffer packet(start, header_size + arena.Fragment(i).size);
+                gop_cache.Push(packet);
+                server.publish("rtp", packet);
+            }
+        }
+    });
+    reader.detach();
+
     server.listen();
 
     // ----- Cleanup -----
@@ -3,7 +3,7 @@
 #include <cstring>
 #include <iostream>
 
-VP8Depacketizer::VP8Depacketizer() {}
+VP8Depacketizer::VP8Depacketizer() : key_frame_(false) {}
 
 VP8Depacketizer::~VP8Depacketizer() {}
 
@@ -13,11 +13,16 @@ bool VP8Depacketizer::Unmarshal(const uint8_t* packet, size_t packet_size,
     return false;
   }
   
+  key_frame_ = false;
   VP8PacketError err = packet_.Unmarshal(packet, packet_size, payload);
   if (err != VP8_PACKET_OK) {
     return false;
   }
-  
+
+  // The first partition starts with the frame tag, whose lowest bit (P) is 0
+  // for keyframes (RFC 6386, section 9.1).
+  key_frame_ = packet_.S() == 1 && packet_.PID() == 0 &&
+               !payload->empty() && ((*payload)[0] & 0x01) == 0;
   return true;
 }
 
@@ -36,7 +41,5 @@ uint16_t VP8Depacketizer::GetPictureID() const {
 }
 
 bool VP8Depacketizer::IsKeyFrame() const {
-  // In VP8, S bit must be 1 for the first packet of a frame
-  // and partition ID (PID) should be 0 for a keyframe's first partition
-  return packet_.S() == 1 && packet_.PID() == 0;
+  return key_frame_;
 }
\ No newline at end of file
@@ -25,11 +25,12 @@ class VP8Depacketizer {
   // Returns current picture ID of the parsed packet
   uint16_t GetPictureID() const;
   
-  // Returns whether the latest parsed packet is a keyframe
+  // Returns whether the latest parsed packet starts a keyframe
   bool IsKeyFrame() const;
 
  private:
   VP8Packet packet_;
+  bool key_frame_;
 };
 
 #endif  // VP8_RTP_DEPACKETIZER_H_
\ No newline at end of file
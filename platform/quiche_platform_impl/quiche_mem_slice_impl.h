@@ -1,11 +1,30 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_MEM_SLICE_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_MEM_SLICE_IMPL_H_
 
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "quiche/common/platform/api/quiche_export.h"
 #include "quiche/common/quiche_default_mem_slice_impl.h"
 
 namespace quiche {
 
-using QuicheMemSliceImpl = QuicheDefaultMemSliceImpl;
+// The default slice, plus slices of a shared immutable buffer. Such a slice
+// holds a reference to `owner` instead of a copy, so one payload can sit in
+// many send queues at once; it is freed when the last slice is released,
+// i.e. once every copy has been acknowledged or dropped.
+// Build one with QuicheMemSlice(QuicheMemSlice::InPlace(), owner, data, size).
+class QUICHE_EXPORT QuicheMemSliceImpl : public QuicheDefaultMemSliceImpl {
+ public:
+  using QuicheDefaultMemSliceImpl::QuicheDefaultMemSliceImpl;
+
+  QuicheMemSliceImpl() = default;
+  QuicheMemSliceImpl(std::shared_ptr<const void> owner, const char* data,
+                     size_t length)
+      : QuicheDefaultMemSliceImpl(
+            data, length, [owner = std::move(owner)](auto /*data*/) {}) {}
+};
 
 }  // namespace quiche
 
@@ -0,0 +1,377 @@
+#include "quiche_platform_impl/quiche_slab_buffer_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace quiche {
+
+namespace {
+
+constexpr size_t kMinClassShift = 6;  // 64 bytes
+constexpr size_t kMaxClassSize = size_t{1}
+                                 << (kMinClassShift + kSlabSizeClassCount - 1);
+// Keeps the payload aligned like operator new's.
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+constexpr uint32_t kLargeClass = 0xffffffff;
+
+constexpr size_t kArenaSize = size_t{2} << 20;
+// Blocks moved between a thread cache and the shared pool at once.
+constexpr size_t kBatchBytes = size_t{64} << 10;
+constexpr size_t kMinBatchBlocks = 4;
+
+struct alignas(kHeaderSize) BlockHeader {
+  uint32_t size_class;
+  // Large allocations only.
+  size_t size;
+};
+static_assert(sizeof(BlockHeader) == kHeaderSize);
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+size_t PayloadSize(size_t size_class) {
+  return size_t{1} << (kMinClassShift + size_class);
+}
+
+size_t BlockSize(size_t size_class) {
+  return kHeaderSize + PayloadSize(size_class);
+}
+
+size_t BatchBlocks(size_t size_class) {
+  return std::max(kMinBatchBlocks, kBatchBytes / BlockSize(size_class));
+}
+
+size_t SizeClassFor(size_t size) {
+  size_t size_class = 0;
+  while (PayloadSize(size_class) < size) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// Counters kept by each thread cache. Only the owning thread writes them,
+// with plain loads and stores, so the allocation path shares no cache line
+// with other threads; atomics only let GetStats() read them meanwhile.
+// Buffers freed on another thread than they came from make that thread's
+// in-use counts wrap below zero, so only the sum over all threads is
+// meaningful.
+struct ThreadCounters {
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> large_allocations{0};
+  std::atomic<uint64_t> large_bytes_in_use{0};
+  std::atomic<uint64_t> blocks_in_use[kSlabSizeClassCount] = {};
+};
+
+using BumpFunction = void (*)(std::atomic<uint64_t>&, uint64_t);
+
+void Bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+}
+
+// For counters more than one thread writes.
+void BumpShared(std::atomic<uint64_t>& counter, uint64_t delta) {
+  counter.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void AddTo(SlabBufferAllocatorStats* stats, const ThreadCounters& counters) {
+  stats->allocations += counters.allocations.load(std::memory_order_relaxed);
+  stats->large_allocations +=
+      counters.large_allocations.load(std::memory_order_relaxed);
+  stats->bytes_in_use +=
+      counters.large_bytes_in_use.load(std::memory_order_relaxed);
+  for (size_t size_class = 0; size_class < kSlabSizeClassCount; ++size_class) {
+    stats->blocks_in_use[size_class] +=
+        counters.blocks_in_use[size_class].load(std::memory_order_relaxed);
+  }
+}
+
+// Counters of the live thread caches, and the totals of exited threads.
+class StatsRegistry {
+ public:
+  static StatsRegistry& Get() {
+    static StatsRegistry* registry = new StatsRegistry();
+    return *registry;
+  }
+
+  void Register(const ThreadCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.push_back(counters);
+  }
+
+  void Unregister(const ThreadCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AddTo(&retired_, *counters);
+    live_.erase(std::find(live_.begin(), live_.end(), counters));
+  }
+
+  SlabBufferAllocatorStats Sum() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SlabBufferAllocatorStats stats = retired_;
+    for (const ThreadCounters* counters : live_) {
+      AddTo(&stats, *counters);
+    }
+    return stats;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<const ThreadCounters*> live_;
+  // Only the counters ThreadCounters has are filled in.
+  SlabBufferAllocatorStats retired_;
+};
+
+// Blocks shared by all threads, and the arena new blocks are carved from.
+class CentralPool {
+ public:
+  static CentralPool& Get() {
+    static CentralPool* pool = new CentralPool();
+    return *pool;
+  }
+
+  // Takes up to `count` blocks of `size_class`, carving new ones if needed.
+  FreeBlock* Take(size_t size_class, size_t count, size_t* taken) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FreeBlock* head = nullptr;
+    *taken = 0;
+    while (*taken < count && lists_[size_class] != nullptr) {
+      FreeBlock* block = lists_[size_class];
+      lists_[size_class] = block->next;
+      block->next = head;
+      head = block;
+      ++*taken;
+    }
+    size_t block_size = BlockSize(size_class);
+    while (*taken < count) {
+      if (static_cast<size_t>(arena_end_ - arena_cursor_) < block_size &&
+          !NewArena()) {
+        break;
+      }
+      auto* block = reinterpret_cast<FreeBlock*>(arena_cursor_);
+      arena_cursor_ += block_size;
+      block->next = head;
+      head = block;
+      ++*taken;
+    }
+    return head;
+  }
+
+  void Return(size_t size_class, FreeBlock* head, FreeBlock* tail) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tail->next = lists_[size_class];
+    lists_[size_class] = head;
+  }
+
+  std::atomic<bool> use_huge_pages{false};
+  // Only change when an arena is added.
+  std::atomic<uint64_t> arena_bytes{0};
+  std::atomic<uint64_t> huge_page_arena_bytes{0};
+
+ private:
+  // The unused tail of the previous arena stays reserved; it is smaller
+  // than one block of the largest class.
+  bool NewArena() {
+    void* arena = ::operator new(kArenaSize, std::align_val_t(kArenaSize),
+                                 std::nothrow);
+    if (arena == nullptr) {
+      return false;
+    }
+    arena_bytes.fetch_add(kArenaSize, std::memory_order_relaxed);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (use_huge_pages.load(std::memory_order_relaxed) &&
+        madvise(arena, kArenaSize, MADV_HUGEPAGE) == 0) {
+      huge_page_arena_bytes.fetch_add(kArenaSize, std::memory_order_relaxed);
+    }
+#endif
+    arena_cursor_ = static_cast<char*>(arena);
+    arena_end_ = arena_cursor_ + kArenaSize;
+    return true;
+  }
+
+  std::mutex mutex_;
+  FreeBlock* lists_[kSlabSizeClassCount] = {};
+  char* arena_cursor_ = nullptr;
+  char* arena_end_ = nullptr;
+};
+
+// Set once this thread's cache starts being destroyed. A trivially
+// destructible thread_local, so destructors of other thread_locals that run
+// later can still read it.
+thread_local bool thread_cache_destroyed = false;
+
+// Per-thread free lists. Returned to the central pool when the thread exits.
+class ThreadCache {
+ public:
+  ThreadCache() { StatsRegistry::Get().Register(&counters_); }
+
+  ~ThreadCache() {
+    thread_cache_destroyed = true;
+    for (size_t size_class = 0; size_class < kSlabSizeClassCount;
+         ++size_class) {
+      if (lists_[size_class] != nullptr) {
+        Spill(size_class, counts_[size_class]);
+      }
+    }
+    StatsRegistry::Get().Unregister(&counters_);
+  }
+
+  ThreadCounters& counters() { return counters_; }
+
+  FreeBlock* Pop(size_t size_class) {
+    if (lists_[size_class] == nullptr) {
+      size_t taken;
+      lists_[size_class] = CentralPool::Get().Take(
+          size_class, BatchBlocks(size_class), &taken);
+      counts_[size_class] = taken;
+      if (taken == 0) {
+        return nullptr;
+      }
+    }
+    FreeBlock* block = lists_[size_class];
+    lists_[size_class] = block->next;
+    --counts_[size_class];
+    return block;
+  }
+
+  void Push(size_t size_class, FreeBlock* block) {
+    block->next = lists_[size_class];
+    lists_[size_class] = block;
+    // A thread that mostly frees, e.g. one sending what another produced,
+    // hands its surplus back.
+    size_t batch = BatchBlocks(size_class);
+    if (++counts_[size_class] > 2 * batch) {
+      Spill(size_class, batch);
+    }
+  }
+
+ private:
+  void Spill(size_t size_class, size_t count) {
+    FreeBlock* head = lists_[size_class];
+    FreeBlock* tail = head;
+    for (size_t i = 1; i < count; ++i) {
+      tail = tail->next;
+    }
+    lists_[size_class] = tail->next;
+    counts_[size_class] -= count;
+    CentralPool::Get().Return(size_class, head, tail);
+  }
+
+  FreeBlock* lists_[kSlabSizeClassCount] = {};
+  size_t counts_[kSlabSizeClassCount] = {};
+  ThreadCounters counters_;
+};
+
+// Null once the thread is exiting and its cache is gone; buffers freed by
+// later thread_local destructors then go straight to the central pool.
+ThreadCache* GetThreadCache() {
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadCache cache;
+  return &cache;
+}
+
+// Counters for buffers allocated or freed without a thread cache.
+ThreadCounters& UncachedCounters() {
+  static ThreadCounters* counters = []() {
+    auto* uncached = new ThreadCounters();
+    StatsRegistry::Get().Register(uncached);
+    return uncached;
+  }();
+  return *counters;
+}
+
+}  // namespace
+
+SlabBufferAllocator* SlabBufferAllocator::Get() {
+  static SlabBufferAllocator* allocator = new SlabBufferAllocator();
+  return allocator;
+}
+
+void SlabBufferAllocator::SetUseHugePages(bool enabled) {
+  CentralPool::Get().use_huge_pages.store(enabled, std::memory_order_relaxed);
+}
+
+SlabBufferAllocatorStats SlabBufferAllocator::GetStats() {
+  SlabBufferAllocatorStats stats = StatsRegistry::Get().Sum();
+  for (size_t size_class = 0; size_class < kSlabSizeClassCount; ++size_class) {
+    stats.bytes_in_use +=
+        stats.blocks_in_use[size_class] * PayloadSize(size_class);
+  }
+  CentralPool& pool = CentralPool::Get();
+  stats.arena_bytes = pool.arena_bytes.load(std::memory_order_relaxed);
+  stats.huge_page_arena_bytes =
+      pool.huge_page_arena_bytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+char* SlabBufferAllocator::New(size_t size) {
+  ThreadCache* cache = GetThreadCache();
+  ThreadCounters& counters =
+      cache != nullptr ? cache->counters() : UncachedCounters();
+  BumpFunction bump = cache != nullptr ? Bump : BumpShared;
+  bump(counters.allocations, 1);
+
+  if (size <= kMaxClassSize) {
+    size_t size_class = SizeClassFor(size);
+    size_t taken;
+    FreeBlock* block = cache != nullptr
+                           ? cache->Pop(size_class)
+                           : CentralPool::Get().Take(size_class, 1, &taken);
+    if (block != nullptr) {
+      bump(counters.blocks_in_use[size_class], 1);
+      auto* header = new (block) BlockHeader();
+      header->size_class = static_cast<uint32_t>(size_class);
+      return reinterpret_cast<char*>(header) + kHeaderSize;
+    }
+    // Out of arena memory; fall through to operator new, which reports the
+    // failure the usual way.
+  }
+
+  bump(counters.large_allocations, 1);
+  bump(counters.large_bytes_in_use, size);
+  auto* header = new (::operator new(kHeaderSize + size)) BlockHeader();
+  header->size_class = kLargeClass;
+  header->size = size;
+  return reinterpret_cast<char*>(header) + kHeaderSize;
+}
+
+char* SlabBufferAllocator::New(size_t size, bool /*flag_enable*/) {
+  return New(size);
+}
+
+void SlabBufferAllocator::Delete(char* buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  auto* header = reinterpret_cast<BlockHeader*>(buffer - kHeaderSize);
+  ThreadCache* cache = GetThreadCache();
+  ThreadCounters& counters =
+      cache != nullptr ? cache->counters() : UncachedCounters();
+  BumpFunction bump = cache != nullptr ? Bump : BumpShared;
+  // Unsigned wraparound: adding -x subtracts x.
+  if (header->size_class == kLargeClass) {
+    bump(counters.large_bytes_in_use, 0 - uint64_t{header->size});
+    ::operator delete(header);
+    return;
+  }
+
+  size_t size_class = header->size_class;
+  bump(counters.blocks_in_use[size_class], ~uint64_t{0});
+  auto* block = reinterpret_cast<FreeBlock*>(header);
+  if (cache != nullptr) {
+    cache->Push(size_class, block);
+  } else {
+    CentralPool::Get().Return(size_class, block, block);
+  }
+}
+
+}  // namespace quiche
@@ -0,0 +1,50 @@
+#ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SLAB_BUFFER_ALLOCATOR_H_
+#define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SLAB_BUFFER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "quiche/common/platform/api/quiche_export.h"
+#include "quiche/common/quiche_buffer_allocator.h"
+
+namespace quiche {
+
+// Size classes are powers of two from 64 bytes to 64 KiB.
+inline constexpr size_t kSlabSizeClassCount = 11;
+
+struct QUICHE_EXPORT SlabBufferAllocatorStats {
+  uint64_t allocations = 0;
+  // Requests above the largest size class, served by operator new.
+  uint64_t large_allocations = 0;
+  uint64_t blocks_in_use[kSlabSizeClassCount] = {};
+  uint64_t bytes_in_use = 0;
+  // Memory reserved for size classes; arenas are never released.
+  uint64_t arena_bytes = 0;
+  uint64_t huge_page_arena_bytes = 0;
+};
+
+// Buffer allocator for stream and datagram payloads. Sizes up to 64 KiB are
+// rounded up to a size class and served from per-thread free lists, which
+// refill in batches from 2 MiB arenas, so the common path takes no lock and
+// does not touch malloc. Buffers may be freed on any thread; they join that
+// thread's free lists, and lists that grow too long spill to a shared pool.
+// During thread exit, once the thread's lists are gone, buffers come from and
+// return to the shared pool directly.
+class QUICHE_EXPORT SlabBufferAllocator : public QuicheBufferAllocator {
+ public:
+  static SlabBufferAllocator* Get();
+
+  // Backs arenas created from now on with transparent huge pages, where the
+  // platform supports them.
+  static void SetUseHugePages(bool enabled);
+
+  static SlabBufferAllocatorStats GetStats();
+
+  char* New(size_t size) override;
+  char* New(size_t size, bool flag_enable) override;
+  void Delete(char* buffer) override;
+};
+
+}  // namespace quiche
+
+#endif  // QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_SLAB_BUFFER_ALLOCATOR_H_
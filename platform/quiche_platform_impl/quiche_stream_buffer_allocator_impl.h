@@ -5,11 +5,11 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_STREAM_BUFFER_ALLOCATOR_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_STREAM_BUFFER_ALLOCATOR_IMPL_H_
 
-#include "quiche/common/simple_buffer_allocator.h"
+#include "quiche_platform_impl/quiche_slab_buffer_allocator.h"
 
 namespace quiche {
 
-using QuicheStreamBufferAllocatorImpl = quiche::SimpleBufferAllocator;
+using QuicheStreamBufferAllocatorImpl = quiche::SlabBufferAllocator;
 
 }  // namespace quiche
 
@@ -2,6 +2,7 @@
 
 // Include internal headers
 #include "web_transport_client.h"
+#include "web_transport_client_context.h"
 #include "web_transport_client_session.h"
 #include "web_transport_client_stream.h"
 #include "web_transport_server.h"
@@ -10,6 +11,82 @@
 
 namespace web_transport {
 
+namespace {
+
+void SetHandle(webtransport::ServerSession* session, std::shared_ptr<void> handle) {
+  session->set_handle(std::move(handle));
+}
+
+void SetHandle(webtransport::ServerStream* stream, std::shared_ptr<void> handle) {
+  stream->set_handle(std::move(handle));
+}
+
+void SetHandle(webtransport::ClientSession* session, std::shared_ptr<void> handle) {
+  session->setHandle(std::move(handle));
+}
+
+void SetHandle(webtransport::ClientBidirectionalStream* stream, std::shared_ptr<void> handle) {
+  stream->setHandle(std::move(handle));
+}
+
+// Returns the one public wrapper of `internal`, creating it on first use. The
+// internal object owns it, so it lives exactly as long as what it wraps.
+template <typename Wrapper, typename Internal>
+Wrapper* WrapperFor(Internal* internal) {
+  if (internal == nullptr) {
+    return nullptr;
+  }
+  if (void* handle = internal->handle()) {
+    return static_cast<Wrapper*>(handle);
+  }
+  auto wrapper = std::make_shared<Wrapper>(internal);
+  Wrapper* raw = wrapper.get();
+  SetHandle(internal, std::move(wrapper));
+  return raw;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// SharedBuffer Implementation
+//-----------------------------------------------------------------------------
+SharedBuffer::SharedBuffer(std::vector<uint8_t> data)
+    : bytes_(std::make_shared<const std::vector<uint8_t>>(std::move(data))) {
+}
+
+SharedBuffer::SharedBuffer(const uint8_t* data, size_t size)
+    : bytes_(std::make_shared<const std::vector<uint8_t>>(data, data + size)) {
+}
+
+const uint8_t* SharedBuffer::data() const {
+  return bytes_ ? bytes_->data() : nullptr;
+}
+
+size_t SharedBuffer::size() const {
+  return bytes_ ? bytes_->size() : 0;
+}
+
+//-----------------------------------------------------------------------------
+// ClientContext Implementation
+//-----------------------------------------------------------------------------
+ClientContext::ClientContext()
+    : context_(std::make_shared<webtransport::ClientContext>()) {
+}
+
+ClientContext::~ClientContext() = default;
+
+void ClientContext::run() {
+  context_->run();
+}
+
+void ClientContext::poll(uint64_t timeout_ms) {
+  context_->poll(timeout_ms);
+}
+
+void ClientContext::stop() {
+  context_->stop();
+}
+
 //-----------------------------------------------------------------------------
 // Client Implementation
 //-----------------------------------------------------------------------------
@@ -17,6 +94,10 @@ Client::Client(const std::string& url)
     : client_(std::make_unique<webtransport::Client>(url)) {
 }
 
+Client::Client(const std::string& url, ClientContext& context)
+    : client_(std::make_unique<webtransport::Client>(url, context.context_)) {
+}
+
 Client::~Client() = default;
 
 void Client::setHeader(const std::string& key, const std::string& value) {
@@ -27,6 +108,14 @@ void Client::setPublicKeyFile(const std::string& file_path) {
   client_->setPublicKeyFile(file_path);
 }
 
+void Client::addServerCertificateHash(const std::string& sha256_hex) {
+  client_->addServerCertificateHash(sha256_hex);
+}
+
+void Client::addServerPublicKeyHash(const std::string& sha256_hex) {
+  client_->addServerPublicKeyHash(sha256_hex);
+}
+
 void Client::setCACertBundleFile(const std::string& file_path) {
   client_->setCACertBundleFile(file_path);
 }
@@ -35,6 +124,10 @@ void Client::setCACertDir(const std::string& dir_path) {
   client_->setCACertDir(dir_path);
 }
 
+void Client::setAsyncCertificateVerification(bool enabled) {
+  client_->setAsyncCertificateVerification(enabled);
+}
+
 void Client::connect() {
   client_->connect();
 }
@@ -47,14 +140,34 @@ void Client::runEventLoop() {
   client_->runEventLoop();
 }
 
+void Client::openSession(const std::string& path,
+                         const std::vector<std::pair<std::string, std::string>>& headers,
+                         std::function<void(void*)> callback) {
+  quiche::HttpHeaderBlock header_block;
+  for (const auto& [key, value] : headers) {
+    header_block[key] = value;
+  }
+
+  std::function<void(webtransport::ClientSession*)> internal_callback;
+  if (callback) {
+    internal_callback = [callback = std::move(callback)](
+                            webtransport::ClientSession* internal_session) {
+      callback(WrapperFor<ClientSession>(internal_session));
+    };
+  }
+  client_->openSession(path, header_block, std::move(internal_callback));
+}
+
+void Client::setMaxSessionsPerConnection(size_t max_sessions) {
+  client_->setMaxSessionsPerConnection(max_sessions);
+}
+
 void Client::onSessionOpen(std::function<void(void*)> callback) {
   session_callback_ = std::move(callback);
   
   client_->onSessionOpen([this](webtransport::ClientSession* internal_session) {
     if (session_callback_) {
-      // Create a wrapper ClientSession and pass it to the user callback
-      auto* session = new ClientSession(internal_session);
-      session_callback_(session);
+      session_callback_(WrapperFor<ClientSession>(internal_session));
     }
   });
 }
@@ -66,10 +179,8 @@ void Client::onBidirectionalStream(std::function<void(void*, void*)> callback) {
     [this](webtransport::ClientSession* internal_session, 
            webtransport::ClientBidirectionalStream* internal_stream) {
       if (bidi_stream_callback_) {
-        // Create wrappers for both session and stream
-        auto* session = new ClientSession(internal_session);
-        auto* stream = new ClientStream(internal_stream);
-        bidi_stream_callback_(session, stream);
+        bidi_stream_callback_(WrapperFor<ClientSession>(internal_session),
+                              WrapperFor<ClientStream>(internal_stream));
       }
     });
 }
@@ -89,14 +200,19 @@ ClientSession::ClientSession(void* session)
 ClientSession::~ClientSession() = default;
 
 void* ClientSession::createBidirectionalStream() {
-  auto* stream = session_->createBidirectionalStream();
-  return stream ? new ClientStream(stream) : nullptr;
+  return WrapperFor<ClientStream>(session_->createBidirectionalStream());
 }
 
 void ClientSession::sendDatagram(const std::vector<uint8_t>& data) {
   session_->SendDatagram(data);
 }
 
+void ClientSession::sendDatagram(const SharedBuffer& data) {
+  if (!data.empty()) {
+    session_->SendDatagram(data.bytes());
+  }
+}
+
 void ClientSession::setInterval(uint64_t interval_ms, std::function<void()> callback) {
   session_->setInterval(interval_ms, std::move(callback));
 }
@@ -105,6 +221,10 @@ void ClientSession::onDatagramRead(std::function<void(std::vector<uint8_t>)> cal
   session_->onDatagramRead(std::move(callback));
 }
 
+void ClientSession::onClose(std::function<void()> callback) {
+  session_->onClose(std::move(callback));
+}
+
 void ClientSession::onBidirectionalStream(std::function<void(void*, void*)> callback) {
   bidi_stream_callback_ = std::move(callback);
   
@@ -112,9 +232,7 @@ void ClientSession::onBidirectionalStream(std::function<void(void*, void*)> call
     [this](webtransport::ClientSession* internal_session, 
            webtransport::ClientBidirectionalStream* internal_stream) {
       if (bidi_stream_callback_) {
-        // We already have a wrapper for the session (this)
-        auto* stream = new ClientStream(internal_stream);
-        bidi_stream_callback_(this, stream);
+        bidi_stream_callback_(this, WrapperFor<ClientStream>(internal_stream));
       }
     });
 }
@@ -132,6 +250,10 @@ bool ClientStream::send(const std::vector<uint8_t>& data) {
   return stream_->Send(data);
 }
 
+bool ClientStream::send(const SharedBuffer& data) {
+  return stream_->Send(data.bytes());
+}
+
 void ClientStream::onStreamRead(std::function<void(std::vector<uint8_t>)> callback) {
   stream_->onStreamRead(std::move(callback));
 }
@@ -140,6 +262,30 @@ void ClientStream::setInterval(uint64_t interval_ms, std::function<void()> callb
   stream_->setInterval(interval_ms, std::move(callback));
 }
 
+bool ClientStream::close() {
+  return stream_->Close();
+}
+
+void ClientStream::reset(uint64_t error_code) {
+  stream_->Reset(error_code);
+}
+
+void ClientStream::onFin(std::function<void()> callback) {
+  stream_->onFin(std::move(callback));
+}
+
+void ClientStream::onReset(std::function<void(uint64_t)> callback) {
+  stream_->onReset(std::move(callback));
+}
+
+void ClientStream::onStopSending(std::function<void(uint64_t)> callback) {
+  stream_->onStopSending(std::move(callback));
+}
+
+void ClientStream::onClose(std::function<void()> callback) {
+  stream_->onClose(std::move(callback));
+}
+
 //-----------------------------------------------------------------------------
 // Server Implementation
 //-----------------------------------------------------------------------------
@@ -157,19 +303,167 @@ void Server::setKeyFile(const std::string& key_file) {
   server_->setKeyFile(key_file);
 }
 
+void Server::addCertificateFiles(const std::string& cert_file, const std::string& key_file) {
+  server_->addCertificateFiles(cert_file, key_file);
+}
+
+void Server::addCertificate(const std::string& chain_pem, const std::string& key_pem) {
+  server_->addCertificate(chain_pem, key_pem);
+}
+
+bool Server::reloadCertificates() {
+  return server_->reloadCertificates();
+}
+
+void Server::setSigningThreads(size_t num_threads) {
+  server_->setSigningThreads(num_threads);
+}
+
+void Server::setHugePageBuffers(bool enabled) {
+  server_->setHugePageBuffers(enabled);
+}
+
+void Server::setTicketKeyFile(const std::string& key_file) {
+  server_->setTicketKeyFile(key_file);
+}
+
+void Server::setTicketKeyCallback(std::function<std::vector<uint8_t>()> callback) {
+  server_->setTicketKeyCallback([callback = std::move(callback)]() {
+    std::vector<uint8_t> material = callback();
+    return std::string(material.begin(), material.end());
+  });
+}
+
+void Server::setTicketKeyRotationInterval(uint64_t seconds) {
+  server_->setTicketKeyRotationInterval(seconds);
+}
+
+void Server::setSourceAddressTokenSecret(const std::string& secret) {
+  server_->setSourceAddressTokenSecret(secret);
+}
+
+void Server::setMaxSessionsToCreatePerSocketEvent(size_t max_sessions) {
+  server_->setMaxSessionsToCreatePerSocketEvent(max_sessions);
+}
+
+void Server::setHandshakeRateLimit(double per_second, double burst) {
+  server_->setHandshakeRateLimit(per_second, burst);
+}
+
+void Server::setPerSourceRateLimit(double per_second, double burst) {
+  server_->setPerSourceRateLimit(per_second, burst);
+}
+
+void Server::setMaxAdmittedWhileBuffering(size_t max_connections) {
+  server_->setMaxAdmittedWhileBuffering(max_connections);
+}
+
+void Server::setMaxSessions(size_t max_sessions) {
+  server_->setMaxSessions(max_sessions);
+}
+
+void Server::setMaxSessionsPerPath(const std::string& path, size_t max_sessions) {
+  server_->setMaxSessionsPerPath(path, max_sessions);
+}
+
+void Server::setMaxNewSessionsPerSecond(double per_second, double burst) {
+  server_->setMaxNewSessionsPerSecond(per_second, burst);
+}
+
+void Server::setMaxEventLoopLag(uint64_t lag_ms) {
+  server_->setMaxEventLoopLag(lag_ms);
+}
+
 void Server::onSession(std::function<bool(void*, const std::string&)> callback) {
   session_callback_ = std::move(callback);
   
   server_->onSession([this](webtransport::ServerSession* internal_session, 
                            const std::string& path) {
     if (session_callback_) {
-      auto* session = new ServerSession(internal_session);
-      return session_callback_(session, path);
+      return session_callback_(WrapperFor<ServerSession>(internal_session), path);
     }
     return true; // Accept by default if no callback set
   });
 }
 
+void* Server::findSession(uint64_t session_id) {
+  return WrapperFor<ServerSession>(server_->findSession(session_id));
+}
+
+std::vector<uint64_t> Server::sessionIds(const std::string& path) const {
+  const auto& sessions = server_->sessions();
+  return path.empty() ? sessions.ids() : sessions.IdsOnPath(path);
+}
+
+void Server::setChannelQueueLimits(size_t max_queued_messages, size_t evict_after_drops) {
+  webtransport::ChannelConfig config;
+  config.max_queued_messages = max_queued_messages;
+  config.evict_after_drops = evict_after_drops;
+  server_->setChannelConfig(config);
+}
+
+void Server::publish(const std::string& channel, const SharedBuffer& data) {
+  server_->broadcaster().GetOrCreateChannel(channel)->Publish(data.bytes());
+}
+
+void Server::subscribe(const std::string& channel, void* session, void* stream) {
+  uint64_t session_id = static_cast<ServerSession*>(session)->id();
+  webtransport::Channel* target = server_->broadcaster().GetOrCreateChannel(channel);
+  if (stream) {
+    target->SubscribeStream(session_id, static_cast<webtransport::ServerStream*>(
+                                            static_cast<ServerStream*>(stream)->stream_));
+  } else {
+    target->SubscribeDatagrams(session_id);
+  }
+}
+
+void Server::unsubscribe(const std::string& channel, void* session) {
+  if (webtransport::Channel* target = server_->broadcaster().FindChannel(channel)) {
+    target->Unsubscribe(static_cast<ServerSession*>(session)->id());
+  }
+}
+
+void Server::attachTopicStream(void* session, void* stream) {
+  server_->topics().AttachControlStream(
+      static_cast<ServerSession*>(session)->id(),
+      static_cast<webtransport::ServerStream*>(static_cast<ServerStream*>(stream)->stream_));
+}
+
+bool Server::publishTopic(const std::string& topic, const SharedBuffer& data) {
+  return server_->topics().Publish(topic, data.bytes());
+}
+
+size_t Server::topicSubscribers(const std::string& topic) const {
+  return server_->topics().SubscriberCount(topic);
+}
+
+void Server::onSessionRequest(std::function<bool(SessionRequest&)> callback) {
+  session_request_callback_ = std::move(callback);
+
+  server_->onSessionRequest([this](webtransport::SessionRequest& internal_request) {
+    if (session_request_callback_) {
+      SessionRequest request(&internal_request);
+      return session_request_callback_(request);
+    }
+    return true;
+  });
+}
+
+void Server::onSessionDeferred(
+    std::function<void(std::shared_ptr<PendingSession>)> callback) {
+  deferred_session_callback_ = std::move(callback);
+
+  server_->onSessionDeferred(
+    [this](std::shared_ptr<webtransport::PendingSession> internal_pending) {
+      if (deferred_session_callback_) {
+        deferred_session_callback_(
+          std::make_shared<PendingSession>(std::move(internal_pending)));
+      } else {
+        internal_pending->accept();
+      }
+    });
+}
+
 void Server::onUnidirectionalStream(
     std::function<void(void*, void*, const std::string&)> callback) {
   unidirectional_callback_ = std::move(callback);
@@ -179,10 +473,10 @@ void Server::onUnidirectionalStream(
            webtransport::ServerUnidirectionalStream* internal_stream,
            const std::string& path) {
       if (unidirectional_callback_) {
-        auto* session = new ServerSession(internal_session);
-        // Cast to ServerStream* before storing as void*
-        auto* stream = new ServerStream(static_cast<webtransport::ServerStream*>(internal_stream));
-        unidirectional_callback_(session, stream, path);
+        // The wrapper is attached to the ServerStream base of either kind.
+        auto* stream = WrapperFor<ServerStream>(
+            static_cast<webtransport::ServerStream*>(internal_stream));
+        unidirectional_callback_(WrapperFor<ServerSession>(internal_session), stream, path);
       }
     });
 }
@@ -196,16 +490,15 @@ void Server::onBidirectionalStream(
            webtransport::ServerBidirectionalStream* internal_stream,
            const std::string& path) {
       if (bidirectional_callback_) {
-        auto* session = new ServerSession(internal_session);
-        // Cast to ServerStream* before storing as void*
-        auto* stream = new ServerStream(static_cast<webtransport::ServerStream*>(internal_stream));
-        bidirectional_callback_(session, stream, path);
+        auto* stream = WrapperFor<ServerStream>(
+            static_cast<webtransport::ServerStream*>(internal_stream));
+        bidirectional_callback_(WrapperFor<ServerSession>(internal_session), stream, path);
       }
     });
 }
 
-void Server::initialize() {
-  server_->InitializeServer();
+bool Server::initialize() {
+  return server_->InitializeServer();
 }
 
 void Server::listen() {
@@ -225,6 +518,12 @@ void ServerSession::sendDatagram(const std::vector<uint8_t>& data) {
   session_->SendDatagram(data);
 }
 
+void ServerSession::sendDatagram(const SharedBuffer& data) {
+  if (!data.empty()) {
+    session_->SendDatagram(data.bytes());
+  }
+}
+
 void ServerSession::setInterval(uint64_t interval_ms, std::function<void()> callback) {
   session_->setInterval(interval_ms, std::move(callback));
 }
@@ -237,6 +536,88 @@ void ServerSession::onDatagramRead(std::function<void(std::vector<uint8_t>)> cal
   session_->onDatagramRead(std::move(callback));
 }
 
+void ServerSession::onSessionClosed(
+    std::function<void(uint32_t, const std::string&)> callback) {
+  session_->onSessionClosed(std::move(callback));
+}
+
+void ServerSession::onClose(std::function<void()> callback) {
+  session_->onClose(std::move(callback));
+}
+
+namespace {
+
+std::vector<std::pair<std::string, std::string>> CopyHeaders(
+    const webtransport::SessionRequest& request) {
+  std::vector<std::pair<std::string, std::string>> headers;
+  for (const auto& header : request.headers()) {
+    headers.emplace_back(std::string(header.first), std::string(header.second));
+  }
+  return headers;
+}
+
+} // namespace
+
+uint64_t ServerSession::id() const {
+  return session_->id();
+}
+
+std::string ServerSession::requestHeader(const std::string& name) const {
+  return std::string(session_->request().header(name));
+}
+
+std::vector<std::pair<std::string, std::string>> ServerSession::requestHeaders() const {
+  return CopyHeaders(session_->request());
+}
+
+//-----------------------------------------------------------------------------
+// SessionRequest Implementation
+//-----------------------------------------------------------------------------
+SessionRequest::SessionRequest(webtransport::SessionRequest* request)
+    : request_(request) {
+}
+
+std::string SessionRequest::path() const {
+  return std::string(request_->path());
+}
+
+std::string SessionRequest::header(const std::string& name) const {
+  return std::string(request_->header(name));
+}
+
+std::vector<std::pair<std::string, std::string>> SessionRequest::headers() const {
+  return CopyHeaders(*request_);
+}
+
+bool SessionRequest::addResponseHeader(const std::string& name, const std::string& value) {
+  return request_->addResponseHeader(name, value);
+}
+
+//-----------------------------------------------------------------------------
+// PendingSession Implementation
+//-----------------------------------------------------------------------------
+PendingSession::PendingSession(std::shared_ptr<webtransport::PendingSession> pending)
+    : pending_(std::move(pending)) {
+}
+
+PendingSession::~PendingSession() = default;
+
+void PendingSession::accept() {
+  pending_->accept();
+}
+
+void PendingSession::reject(int status) {
+  pending_->reject(status);
+}
+
+const std::string& PendingSession::path() const {
+  return pending_->path();
+}
+
+void* PendingSession::session() const {
+  return WrapperFor<ServerSession>(pending_->session());
+}
+
 //-----------------------------------------------------------------------------
 // ServerStream Implementation
 //-----------------------------------------------------------------------------
@@ -251,6 +632,10 @@ void ServerStream::send(const std::vector<uint8_t>& data) {
   static_cast<webtransport::ServerStream*>(stream_)->Send(data);
 }
 
+bool ServerStream::send(const SharedBuffer& data) {
+  return static_cast<webtransport::ServerStream*>(stream_)->Send(data.bytes());
+}
+
 void ServerStream::setInterval(uint64_t interval_ms, std::function<void()> callback) {
   static_cast<webtransport::ServerStream*>(stream_)->setInterval(interval_ms, std::move(callback));
 }
@@ -259,4 +644,28 @@ void ServerStream::onStreamRead(std::function<void(std::vector<uint8_t>)> callba
   static_cast<webtransport::ServerStream*>(stream_)->onStreamRead(std::move(callback));
 }
 
+bool ServerStream::close() {
+  return static_cast<webtransport::ServerStream*>(stream_)->Close();
+}
+
+void ServerStream::reset(uint64_t error_code) {
+  static_cast<webtransport::ServerStream*>(stream_)->Reset(error_code);
+}
+
+void ServerStream::onFin(std::function<void()> callback) {
+  static_cast<webtransport::ServerStream*>(stream_)->onFin(std::move(callback));
+}
+
+void ServerStream::onReset(std::function<void(uint64_t)> callback) {
+  static_cast<webtransport::ServerStream*>(stream_)->onReset(std::move(callback));
+}
+
+void ServerStream::onStopSending(std::function<void(uint64_t)> callback) {
+  static_cast<webtransport::ServerStream*>(stream_)->onStopSending(std::move(callback));
+}
+
+void ServerStream::onClose(std::function<void()> callback) {
+  static_cast<webtransport::ServerStream*>(stream_)->onClose(std::move(callback));
+}
+
 } // namespace web_transport
\ No newline at end of file
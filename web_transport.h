@@ -5,22 +5,77 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 // Forward declarations to avoid including internal headers
 namespace webtransport {
   class Client;
+  class ClientContext;
   class ClientSession;
   class ClientBidirectionalStream;
   class Server;
   class ServerSession;
+  class PendingSession;
+  class SessionRequest;
   class ServerUnidirectionalStream;
   class ServerBidirectionalStream;
 }
 
-// Public API namespace to avoid conflicts with internal implementations
+// Public API namespace to avoid conflicts with internal implementations.
+//
+// Sessions and streams are handed out as void* handles. Each internal session
+// or stream has exactly one handle, owned by the library and freed when the
+// session or stream goes away; never delete a handle, and stop using it once
+// its onClose callback has run.
 namespace web_transport {
 
+class PendingSession;
+class SessionRequest;
+
+//-----------------------------------------------------------------------------
+// SharedBuffer
+//-----------------------------------------------------------------------------
+// Immutable, reference-counted bytes. Sending one SharedBuffer to many streams
+// queues the same memory on each of them instead of a copy per stream; it is
+// freed once the last stream is done with it. Cheap to copy, thread-safe to
+// share.
+class SharedBuffer {
+public:
+  SharedBuffer() = default;
+  explicit SharedBuffer(std::vector<uint8_t> data);
+  SharedBuffer(const uint8_t* data, size_t size);
+
+  const uint8_t* data() const;
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  const std::shared_ptr<const std::vector<uint8_t>>& bytes() const { return bytes_; }
+
+private:
+  std::shared_ptr<const std::vector<uint8_t>> bytes_;
+};
+
+//-----------------------------------------------------------------------------
+// ClientContext API
+//-----------------------------------------------------------------------------
+// Event loop, clock and TLS session cache shared by many clients, so that one
+// thread can drive thousands of outbound connections.
+class ClientContext {
+public:
+  ClientContext();
+  ~ClientContext();
+
+  // Runs until stop() is called or no attached client is connected.
+  void run();
+  // Processes pending events, waiting at most timeout_ms for new ones.
+  void poll(uint64_t timeout_ms = 0);
+  void stop();
+
+private:
+  friend class Client;
+  std::shared_ptr<webtransport::ClientContext> context_;
+};
+
 //-----------------------------------------------------------------------------
 // Client API
 //-----------------------------------------------------------------------------
@@ -28,17 +83,33 @@ class Client {
 public:
   // Constructor that takes a WebTransport URL
   Client(const std::string& url);
+  // Constructor for a client driven by a shared ClientContext
+  Client(const std::string& url, ClientContext& context);
   ~Client();
 
   // Connection setup
   void setHeader(const std::string& key, const std::string& value);
   void setPublicKeyFile(const std::string& file_path);
+  // Pins the server by SHA-256 (hex) of its certificate or of its public key
+  // (SubjectPublicKeyInfo), like serverCertificateHashes in browsers.
+  void addServerCertificateHash(const std::string& sha256_hex);
+  void addServerPublicKeyHash(const std::string& sha256_hex);
   void setCACertBundleFile(const std::string& file_path);
   void setCACertDir(const std::string& dir_path);
+  // Verifies certificate chains on worker threads rather than the event loop.
+  void setAsyncCertificateVerification(bool enabled);
   void connect();
   void disconnect();
   void runEventLoop();
 
+  // Opens another session on this client's origin. Sessions share one QUIC
+  // connection while it has room for them, so they open in a single round
+  // trip. The session is passed to `callback`, or to onSessionOpen if empty.
+  void openSession(const std::string& path,
+                   const std::vector<std::pair<std::string, std::string>>& headers = {},
+                   std::function<void(void*)> callback = nullptr);
+  void setMaxSessionsPerConnection(size_t max_sessions);
+
   // Callback registration
   void onSessionOpen(std::function<void(void*)> callback);
   void onBidirectionalStream(std::function<void(void*, void*)> callback);
@@ -63,9 +134,12 @@ public:
 
   void* createBidirectionalStream();
   void sendDatagram(const std::vector<uint8_t>& data);
+  void sendDatagram(const SharedBuffer& data);
   void setInterval(uint64_t interval_ms, std::function<void()> callback);
   void onDatagramRead(std::function<void(std::vector<uint8_t>)> callback);
   void onBidirectionalStream(std::function<void(void*, void*)> callback);
+  // Called once when the session closes; the handle is freed right after.
+  void onClose(std::function<void()> callback);
 
 private:
   webtransport::ClientSession* session_;
@@ -81,8 +155,20 @@ public:
   ~ClientStream();
 
   bool send(const std::vector<uint8_t>& data);
+  bool send(const SharedBuffer& data);
   void onStreamRead(std::function<void(std::vector<uint8_t>)> callback);
   void setInterval(uint64_t interval_ms, std::function<void()> callback);
+  // Sends a FIN after the data written so far.
+  bool close();
+  // Aborts the stream in both directions.
+  void reset(uint64_t error_code);
+  // The peer finished sending; the read callback is released afterwards.
+  void onFin(std::function<void()> callback);
+  // The peer aborted its side of the stream, or asked us to stop sending.
+  void onReset(std::function<void(uint64_t)> callback);
+  void onStopSending(std::function<void(uint64_t)> callback);
+  // Called once when the stream is gone; the handle is freed right after.
+  void onClose(std::function<void()> callback);
 
 private:
   webtransport::ClientBidirectionalStream* stream_;
@@ -99,14 +185,90 @@ public:
   // Server configuration
   void setCertFile(const std::string& cert_file);
   void setKeyFile(const std::string& key_file);
+  // Extra certificates, chosen by SNI (ECDSA preferred when a name has
+  // several). reloadCertificates() swaps in fresh copies of every
+  // certificate file while the server runs.
+  void addCertificateFiles(const std::string& cert_file, const std::string& key_file);
+  void addCertificate(const std::string& chain_pem, const std::string& key_pem);
+  bool reloadCertificates();
+  // Threads computing handshake signatures off the event loop (0 = inline).
+  void setSigningThreads(size_t num_threads);
+  // Back the process-wide stream buffer pool with huge pages where available.
+  void setHugePageBuffers(bool enabled);
+
+  // Session resumption. Key material is a sequence of 48-byte records (16-byte
+  // name + 32-byte key); the first record encrypts, the rest only decrypt.
+  // Servers sharing the same keys can resume each other's sessions.
+  void setTicketKeyFile(const std::string& key_file);
+  void setTicketKeyCallback(std::function<std::vector<uint8_t>()> callback);
+  void setTicketKeyRotationInterval(uint64_t seconds);
+  // Keys the address tokens of returning clients. Defaults to a random
+  // per-process secret; servers behind one load balancer must share one.
+  void setSourceAddressTokenSecret(const std::string& secret);
+
+  // New-connection flood protection. Above `per_second` new connections,
+  // only clients holding an address token from an earlier connection are
+  // admitted freely. Rates of 0 disable a limit; a `burst` below 1 defaults
+  // to `per_second` (at least 1).
+  void setMaxSessionsToCreatePerSocketEvent(size_t max_sessions);
+  void setHandshakeRateLimit(double per_second, double burst);
+  // Per source /24 (IPv4) or /56 (IPv6).
+  void setPerSourceRateLimit(double per_second, double burst);
+  // Caps connections admitted while earlier handshakes still wait for a
+  // session; an upper bound on quiche's CHLO buffer, which isn't exposed.
+  void setMaxAdmittedWhileBuffering(size_t max_connections);
+
+  // Session admission control: requests over a limit get 429 at CONNECT
+  // time. 0 disables a limit; a `burst` below 1 defaults to `per_second`
+  // (at least 1).
+  void setMaxSessions(size_t max_sessions);
+  void setMaxSessionsPerPath(const std::string& path, size_t max_sessions);
+  void setMaxNewSessionsPerSecond(double per_second, double burst);
+  void setMaxEventLoopLag(uint64_t lag_ms);
   
   // Event handlers
   void onSession(std::function<bool(void*, const std::string&)> callback);
+  // Live sessions by id; ids stay unique for the server's lifetime. Use only
+  // on the server thread, e.g. from callbacks or intervals.
+  void* findSession(uint64_t session_id);
+  // All session ids, or those on `path` (query string ignored) if set.
+  std::vector<uint64_t> sessionIds(const std::string& path = "") const;
+
+  // Channels fan one payload out to every subscribed session without a copy
+  // per stream. publish() may be called from any thread, e.g. a capture or
+  // socket reader; delivery happens on the server thread within a
+  // millisecond. subscribe() takes ServerSession and ServerStream handles
+  // and must be called on the server thread; without a stream the session
+  // receives datagrams. Stream messages carry a 4-byte big-endian length
+  // prefix, and a subscriber whose stream stays blocked is dropped.
+  void setChannelQueueLimits(size_t max_queued_messages, size_t evict_after_drops);
+  void publish(const std::string& channel, const SharedBuffer& data);
+  void subscribe(const std::string& channel, void* session, void* stream = nullptr);
+  void unsubscribe(const std::string& channel, void* session);
+
+  // Topic publish/subscribe. Hand a session's bidirectional stream to
+  // attachTopicStream() and the client subscribes over it with
+  // "SUB <topic>\n" / "UNSUB <topic>\n" lines; each message published to a
+  // topic arrives on that stream as "MSG <topic> <length>\n" and the
+  // payload. publishTopic() may be called from any thread and returns false
+  // if the topic has no subscribers.
+  void attachTopicStream(void* session, void* stream);
+  bool publishTopic(const std::string& topic, const SharedBuffer& data);
+  size_t topicSubscribers(const std::string& topic) const;
+
+  // Runs while the CONNECT request is answered, before onSession; returning
+  // false refuses the session with 403.
+  void onSessionRequest(std::function<bool(SessionRequest&)> callback);
+  // Takes precedence over onSession. The CONNECT response is held until
+  // accept() or reject() is called on the handle, which may happen later and
+  // from any thread. Must be set before initialize().
+  void onSessionDeferred(std::function<void(std::shared_ptr<PendingSession>)> callback);
   void onUnidirectionalStream(std::function<void(void*, void*, const std::string&)> callback);
   void onBidirectionalStream(std::function<void(void*, void*, const std::string&)> callback);
   
-  // Server lifecycle
-  void initialize();
+  // Server lifecycle. initialize() returns false if the certificates, ticket
+  // keys or socket can't be set up.
+  bool initialize();
   void listen();
 
 private:
@@ -114,6 +276,8 @@ private:
   
   // Wrapper callbacks
   std::function<bool(void*, const std::string&)> session_callback_;
+  std::function<bool(SessionRequest&)> session_request_callback_;
+  std::function<void(std::shared_ptr<PendingSession>)> deferred_session_callback_;
   std::function<void(void*, void*, const std::string&)> unidirectional_callback_;
   std::function<void(void*, void*, const std::string&)> bidirectional_callback_;
 };
@@ -127,14 +291,60 @@ public:
   ~ServerSession();
 
   void sendDatagram(const std::vector<uint8_t>& data);
+  void sendDatagram(const SharedBuffer& data);
   void setInterval(uint64_t interval_ms, std::function<void()> callback);
   void rejectSession(uint32_t error_code = 0, const std::string& reason = "");
   void onDatagramRead(std::function<void(std::vector<uint8_t>)> callback);
+  // The session was closed, by either side, with this code and reason.
+  void onSessionClosed(std::function<void(uint32_t, const std::string&)> callback);
+  // Called once when the session closes; the handle is freed shortly after.
+  void onClose(std::function<void()> callback);
+  uint64_t id() const;
+  // Headers of the CONNECT request that opened the session.
+  std::string requestHeader(const std::string& name) const;
+  std::vector<std::pair<std::string, std::string>> requestHeaders() const;
 
 private:
   webtransport::ServerSession* session_;
 };
 
+//-----------------------------------------------------------------------------
+// SessionRequest API
+//-----------------------------------------------------------------------------
+// CONNECT request seen by onSessionRequest. Header names are lowercase.
+class SessionRequest {
+public:
+  SessionRequest(webtransport::SessionRequest* request);
+
+  std::string path() const;
+  std::string header(const std::string& name) const;
+  std::vector<std::pair<std::string, std::string>> headers() const;
+  // Sent with the response to this request.
+  bool addResponseHeader(const std::string& name, const std::string& value);
+
+private:
+  webtransport::SessionRequest* request_;
+};
+
+//-----------------------------------------------------------------------------
+// PendingSession API
+//-----------------------------------------------------------------------------
+class PendingSession {
+public:
+  PendingSession(std::shared_ptr<webtransport::PendingSession> pending);
+  ~PendingSession();
+
+  void accept();
+  // Answers the CONNECT with `status` (4xx or 5xx).
+  void reject(int status = 403);
+  const std::string& path() const;
+  // ServerSession wrapper; use only on the server thread while it's open.
+  void* session() const;
+
+private:
+  std::shared_ptr<webtransport::PendingSession> pending_;
+};
+
 //-----------------------------------------------------------------------------
 // ServerStream API
 //-----------------------------------------------------------------------------
@@ -144,10 +354,24 @@ public:
   ~ServerStream();
 
   void send(const std::vector<uint8_t>& data);
+  bool send(const SharedBuffer& data);
   void setInterval(uint64_t interval_ms, std::function<void()> callback);
   void onStreamRead(std::function<void(std::vector<uint8_t>)> callback);
+  // Sends a FIN after the data written so far.
+  // Returns false on streams the client opened as unidirectional.
+  bool close();
+  // Aborts the stream in both directions.
+  void reset(uint64_t error_code);
+  // The peer finished sending; the read callback is released afterwards.
+  void onFin(std::function<void()> callback);
+  // The peer aborted its side of the stream, or asked us to stop sending.
+  void onReset(std::function<void(uint64_t)> callback);
+  void onStopSending(std::function<void(uint64_t)> callback);
+  // Called once when the stream is gone; the handle is freed right after.
+  void onClose(std::function<void()> callback);
 
 private:
+  friend class Server;
   void* stream_; // Can be either ServerUnidirectionalStream or ServerBidirectionalStream
 };
 
@@ -3,6 +3,8 @@
 #include "web_transport_client_stream.h"
 #include "web_transport_client_interval.h"
 
+#include <algorithm>
+
 #ifdef _WIN32
 // Include Windows sockets header and link against ws2_32.lib
 #include <winsock2.h>
@@ -18,17 +20,12 @@ namespace webtransport
   class Client::HandshakeAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
   {
   public:
-    HandshakeAlarmDelegate(Client *client, const quic::QuicClock *clock)
-        : client_(client), clock_(clock) {}
+    HandshakeAlarmDelegate(Client *client, Connection *connection, const quic::QuicClock *clock)
+        : client_(client), connection_(connection), clock_(clock) {}
 
     void OnAlarm() override
     {
-      auto *session = client_->client_->client_session();
-      if (session)
-      {
-        client_->CreateWebTransportSession();
-      }
-      else
+      if (client_->CheckConnectionAttempts(connection_))
       {
         alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(10));
       }
@@ -38,6 +35,7 @@ namespace webtransport
 
   private:
     Client *client_;
+    Connection *connection_;
     const quic::QuicClock *clock_;
     quic::QuicAlarm *alarm_;
   };
@@ -46,23 +44,22 @@ namespace webtransport
   class Client::SessionReadyAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
   {
   public:
-    SessionReadyAlarmDelegate(Client *client, quic::QuicSpdyClientStream *stream,
+    SessionReadyAlarmDelegate(Client *client, Connection *connection,
+                              quic::QuicSpdyClientStream *stream,
+                              std::function<void(ClientSession *)> callback,
                               const quic::QuicClock *clock)
-        : client_(client), stream_(stream), clock_(clock) {}
+        : client_(client), connection_(connection), stream_(stream),
+          callback_(std::move(callback)), clock_(clock) {}
 
     void OnAlarm() override
     {
-      auto *session = client_->client_->client_session();
+      auto *session = connection_->client->client_session();
 
       // First check if the client session is still valid
       if (!session)
       {
         // Client session is gone, likely due to connection error
-        if (client_->session_error_callback_)
-        {
-          client_->session_error_callback_("Connection lost or failed");
-        }
-        client_->connected_ = false; // Stop the event loop
+        client_->OnSessionFailed(connection_, "Connection lost or failed", false);
         return;
       }
 
@@ -71,16 +68,7 @@ namespace webtransport
       // Check if the stream was reset or connection error
       if (stream_->stream_error() || stream_->connection_error())
       {
-        std::string error_msg = "Stream reset or connection error";
-        if (client_->session_error_callback_)
-        {
-          client_->session_error_callback_(error_msg);
-        }
-        else
-        {
-          std::cout << "Session error: " << error_msg << std::endl;
-        }
-        client_->connected_ = false; // Stop the event loop
+        client_->OnSessionFailed(connection_, "Stream reset or connection error", true);
         return;
       }
 
@@ -88,17 +76,33 @@ namespace webtransport
       if (wt_session && wt_session->ready())
       {
         auto client_session =
-            new ClientSession(wt_session, client_->alarm_factory_.get(), client_->clock_);
+            new ClientSession(wt_session, client_->alarm_factory_, client_->clock_);
         // Propagate any error callback.
         if (client_->session_error_callback_)
         {
           client_session->setErrorCallback(client_->session_error_callback_);
         }
-        if (client_->session_callback_)
+        auto &callback = callback_ ? callback_ : client_->session_callback_;
+        if (callback)
         {
-          client_->session_callback_(client_session);
+          callback(client_session);
         }
         client_session->onBidirectionalStream(client_->bidi_stream_callback_);
+
+        // The session outlives this alarm, so find the connection by id when
+        // it closes.
+        Client *client = client_;
+        std::weak_ptr<bool> alive = client_->alive_;
+        uint64_t connection_id = connection_->id;
+        client_session->setReleaseCallback(
+            [client, alive, connection_id]()
+            {
+              if (!alive.expired())
+              {
+                client->OnSessionClosed(connection_id);
+              }
+            });
+        client_->ScheduleCleanup();
       }
       // Check if the stream indicates rejection
       else if (stream_->headers_decompressed())
@@ -118,17 +122,15 @@ namespace webtransport
           status = "unknown";
         }
 
-        std::string error_msg = "Server rejected WebTransport session with status: " + status;
-
-        if (client_->session_error_callback_)
+        // The server has no room for another session on this connection; send
+        // later sessions over a new one.
+        if (status == "429")
         {
-          client_->session_error_callback_(error_msg);
+          connection_->max_sessions = connection_->session_count - 1;
         }
-        else
-        {
-          std::cout << "Session error: " << error_msg << std::endl;
-        }
-        client_->connected_ = false; // Stop the event loop
+
+        client_->OnSessionFailed(
+            connection_, "Server rejected WebTransport session with status: " + status, true);
       }
       // Otherwise, keep checking
       else
@@ -141,12 +143,30 @@ namespace webtransport
 
   private:
     Client *client_;
+    Connection *connection_;
     quic::QuicSpdyClientStream *stream_;
+    std::function<void(ClientSession *)> callback_;
     const quic::QuicClock *clock_;
     quic::QuicAlarm *alarm_;
   };
 
+  // Delegate dropping finished alarms and dead connections.
+  class Client::CleanupAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+  {
+  public:
+    explicit CleanupAlarmDelegate(Client *client) : client_(client) {}
+
+    void OnAlarm() override { client_->Cleanup(); }
+
+  private:
+    Client *client_;
+  };
+
   Client::Client(const std::string &url)
+      : Client(url, std::make_shared<ClientContext>()) {}
+
+  Client::Client(const std::string &url, std::shared_ptr<ClientContext> context)
+      : context_(std::move(context))
   {
 #ifdef _WIN32
     // Initialize Windows Sockets API
@@ -158,11 +178,13 @@ namespace webtransport
     }
 #endif
 
-    event_loop_ = quic::GetDefaultEventLoop()->Create(quic::QuicDefaultClock::Get());
-    clock_ = event_loop_->GetClock();
-    alarm_factory_ = event_loop_->CreateAlarmFactory();
+    event_loop_ = context_->event_loop();
+    clock_ = context_->clock();
+    alarm_factory_ = context_->alarm_factory();
+    cleanup_alarm_.reset(alarm_factory_->CreateAlarm(new CleanupAlarmDelegate(this)));
     ParseUrl(url);
     SetDefaultHeaders();
+    SetConnected(true);
   }
 
   Client::~Client()
@@ -171,8 +193,10 @@ namespace webtransport
     WSACleanup();
 #endif
 
-    connected_ = false;
+    SetConnected(false);
+    cleanup_alarm_->Cancel();
     event_loop_->RunEventLoopOnce(quic::QuicTime::Delta::Zero());
+    CloseConnections();
   }
 
   void Client::setHeader(const std::string &key, const std::string &value)
@@ -187,22 +211,103 @@ namespace webtransport
 
   void Client::setPublicKeyFile(std::string file_path)
   {
+    auto pins = std::make_shared<CertificatePins>();
+    if (!pins->AddCertificateFile(file_path))
+    {
+      throw std::runtime_error("Failed to load pinned certificate from file: " + file_path);
+    }
     public_key_file = file_path;
+    pins_ = std::move(pins);
+  }
+
+  void Client::addServerCertificateHash(const std::string &sha256_hex)
+  {
+    auto pins = pins_ ? std::make_shared<CertificatePins>(*pins_)
+                      : std::make_shared<CertificatePins>();
+    if (!pins->AddCertificateHash(sha256_hex))
+    {
+      throw std::invalid_argument("Invalid SHA-256 certificate hash: " + sha256_hex);
+    }
+    pins_ = std::move(pins);
+  }
+
+  void Client::addServerPublicKeyHash(const std::string &sha256_hex)
+  {
+    auto pins = pins_ ? std::make_shared<CertificatePins>(*pins_)
+                      : std::make_shared<CertificatePins>();
+    if (!pins->AddPublicKeyHash(sha256_hex))
+    {
+      throw std::invalid_argument("Invalid SHA-256 public key hash: " + sha256_hex);
+    }
+    pins_ = std::move(pins);
   }
 
   void Client::setCACertBundleFile(std::string file_path)
   {
     ca_cert_bundle_path = file_path;
+    trust_store_.reset();
   }
 
   void Client::setCACertDir(std::string dir_path)
   {
     ca_cert_dir = dir_path;
+    trust_store_.reset();
+  }
+
+  bool Client::reloadCACerts()
+  {
+    if (!trust_store_)
+    {
+      // Loaded on the next handshake.
+      return true;
+    }
+    return trust_store_->Reload();
+  }
+
+  void Client::setAsyncCertificateVerification(bool enabled)
+  {
+    async_verification_ = enabled;
   }
 
   void Client::connect()
   {
-    SetupNetworkComponents();
+    openSession(url_.path(), quiche::HttpHeaderBlock());
+  }
+
+  void Client::openSession(const std::string &path, const quiche::HttpHeaderBlock &headers,
+                           std::function<void(ClientSession *)> callback)
+  {
+    SessionRequest request;
+    request.headers = headers_.Clone();
+    request.headers[":path"] = path;
+    for (const auto &[key, value] : headers)
+    {
+      request.headers[key] = value;
+    }
+    request.callback = std::move(callback);
+
+    Connection *connection = AcquireConnection();
+    ++connection->session_count;
+    ++live_sessions_;
+    SetConnected(true);
+    if (connection->client)
+    {
+      CreateWebTransportSession(connection, std::move(request));
+    }
+    else
+    {
+      connection->queued.push_back(std::move(request));
+    }
+  }
+
+  void Client::setMaxSessionsPerConnection(size_t max_sessions)
+  {
+    max_sessions_per_connection_ = max_sessions;
+  }
+
+  void Client::setConnectionAttemptDelay(uint64_t delay_ms)
+  {
+    connection_attempt_delay_ = quic::QuicTime::Delta::FromMilliseconds(delay_ms);
   }
 
   const quiche::HttpHeaderBlock &Client::getHeaders() const
@@ -235,22 +340,35 @@ namespace webtransport
 
   void Client::disconnect()
   {
-    connected_ = false;
+    SetConnected(false);
     // Clear any pending alarms
-    if (handshake_alarm_)
+    cleanup_alarm_->Cancel();
+    for (auto &connection : connections_)
     {
-      handshake_alarm_->Cancel();
-    }
-    if (session_ready_alarm_)
-    {
-      session_ready_alarm_->Cancel();
+      if (connection->handshake_alarm)
+      {
+        connection->handshake_alarm->Cancel();
+      }
+      for (auto &alarm : connection->session_ready_alarms)
+      {
+        alarm->Cancel();
+      }
     }
 
     // Give event loop a chance to process any final events
     event_loop_->RunEventLoopOnce(quic::QuicTime::Delta::Zero());
 
-    // Clear the client which will close the connection
-    client_.reset();
+    CloseConnections();
+    live_sessions_ = 0;
+  }
+
+  void Client::CloseConnections()
+  {
+    // Clear the clients which will close the connections. Sessions closing
+    // with them look their connection up in connections_, so empty it first.
+    std::vector<std::unique_ptr<Connection>> connections = std::move(connections_);
+    connections_.clear();
+    connections.clear();
   }
 
   void Client::ParseUrl(const std::string &url_str)
@@ -272,11 +390,97 @@ namespace webtransport
     headers_["origin"] = absl::StrCat(url_.scheme(), "://", url_.host());
   }
 
-  void Client::SetupNetworkComponents()
+  Client::Connection *Client::AcquireConnection()
+  {
+    for (auto &connection : connections_)
+    {
+      // A connection still racing its handshakes accepts sessions too; they
+      // are queued until it is established.
+      bool usable = connection->client ? connection->client->connected() : !connection->failed;
+      if (usable && connection->session_count < connection->max_sessions)
+      {
+        return connection.get();
+      }
+    }
+
+    auto connection = std::make_unique<Connection>();
+    connection->id = next_connection_id_++;
+    connection->max_sessions = max_sessions_per_connection_;
+    connections_.push_back(std::move(connection));
+
+    // The lookup may complete synchronously from the cache, so look the
+    // connection up by id rather than holding on to the pointer.
+    uint64_t id = connections_.back()->id;
+    std::weak_ptr<bool> alive = alive_;
+    context_->resolver()->Resolve(
+        url_.host(), url_.port(),
+        [this, alive, id](std::vector<quic::QuicSocketAddress> addresses, bool complete)
+        {
+          if (alive.expired())
+          {
+            return;
+          }
+          Connection *resolved = FindConnection(id);
+          if (resolved)
+          {
+            OnAddressesResolved(resolved, std::move(addresses), complete);
+          }
+        });
+
+    return FindConnection(id);
+  }
+
+  Client::Connection *Client::FindConnection(uint64_t id)
+  {
+    for (auto &connection : connections_)
+    {
+      if (connection->id == id)
+      {
+        return connection.get();
+      }
+    }
+    return nullptr;
+  }
+
+  void Client::OnAddressesResolved(Connection *connection,
+                                   std::vector<quic::QuicSocketAddress> addresses, bool complete)
   {
-    server_address_ = quic::tools::LookupAddress(
-        AF_UNSPEC, url_.host(), std::to_string(url_.port()));
+    if (complete)
+    {
+      connection->resolving = false;
+    }
+    if (connection->client || connection->failed)
+    {
+      // The race is already decided.
+      return;
+    }
+
+    // Merge with the addresses not tried yet so the families stay
+    // interleaved.
+    addresses.insert(addresses.end(), connection->candidates.begin(),
+                     connection->candidates.end());
+    auto sorted = ClientResolver::SortForRacing(addresses);
+    connection->candidates.assign(sorted.begin(), sorted.end());
+
+    if (connection->handshake_alarm)
+    {
+      // The running race picks the new candidates up.
+      return;
+    }
+    if (connection->candidates.empty())
+    {
+      if (!connection->resolving)
+      {
+        OnConnectionFailed(connection, "Unable to resolve " + url_.host());
+      }
+      return;
+    }
+    StartHandshakeCheck(connection);
+  }
 
+  std::unique_ptr<quic::QuicDefaultClient> Client::SetupNetworkComponents(
+      const quic::QuicSocketAddress &address)
+  {
     quic::QuicConfig config;
     //config.SetMaxUnidirectionalStreamsToSend(1000);
     //config.set_max_time_before_crypto_handshake(
@@ -299,46 +503,219 @@ namespace webtransport
 
 
     std::unique_ptr<quic::ProofVerifier> verifier;
-    verifier = std::make_unique<webtransport::BoringSSLProofVerifier>(
-        public_key_file, ca_cert_bundle_path, ca_cert_dir);
+    if (pins_)
+    {
+      verifier = std::make_unique<webtransport::BoringSSLProofVerifier>(pins_);
+    }
+    else
+    {
+      if (!trust_store_)
+      {
+        trust_store_ = std::make_shared<CertificateTrustStore>(ca_cert_bundle_path, ca_cert_dir);
+      }
+      auto ca_verifier = std::make_unique<webtransport::BoringSSLProofVerifier>(trust_store_);
+      if (async_verification_)
+      {
+        ca_verifier->set_verification_pool(context_->verification_pool());
+      }
+      verifier = std::move(ca_verifier);
+    }
 
-    client_ = std::make_unique<quic::QuicDefaultClient>(
-        server_address_, quic::QuicServerId(url_.host(), url_.port()),
-        quic::CurrentSupportedVersions(), config, event_loop_.get(),
+    auto client = std::make_unique<quic::QuicDefaultClient>(
+        address, quic::QuicServerId(url_.host(), url_.port()),
+        quic::CurrentSupportedVersions(), config, event_loop_,
         std::move(verifier),
-        std::make_unique<quic::QuicClientSessionCache>());
+        context_->CreateSessionCache());
+
+    client->set_enable_web_transport(true);
+    client->set_use_datagram_contexts(true);
+
+    // StartConnect() only sends the first flight; the handshake alarm
+    // watches it complete instead of blocking the event loop.
+    if (!client->Initialize())
+    {
+      return nullptr;
+    }
+    client->StartConnect();
+    return client;
+  }
+
+  void Client::StartHandshakeCheck(Connection *connection)
+  {
+    auto delegate = new HandshakeAlarmDelegate(this, connection, clock_);
+    connection->handshake_alarm.reset(alarm_factory_->CreateAlarm(delegate));
+    delegate->SetAlarm(connection->handshake_alarm.get());
+    connection->handshake_alarm->Set(clock_->Now());
+  }
+
+  bool Client::CheckConnectionAttempts(Connection *connection)
+  {
+    // The first attempt to finish its handshake wins the race.
+    for (auto it = connection->attempts.begin(); it != connection->attempts.end(); ++it)
+    {
+      auto *session = (*it)->client_session();
+      if ((*it)->connected() && session && session->OneRttKeysAvailable())
+      {
+        connection->client = std::move(*it);
+        connection->attempts.clear();
+        connection->candidates.clear();
+        server_address_ = connection->client->server_address();
+
+        std::vector<SessionRequest> queued = std::move(connection->queued);
+        connection->queued.clear();
+        for (auto &request : queued)
+        {
+          CreateWebTransportSession(connection, std::move(request));
+        }
+        return false;
+      }
+    }
+
+    // Drop attempts whose handshake has failed.
+    connection->attempts.erase(
+        std::remove_if(connection->attempts.begin(), connection->attempts.end(),
+                       [](const std::unique_ptr<quic::QuicDefaultClient> &attempt)
+                       { return !attempt->connected(); }),
+        connection->attempts.end());
+
+    // Start the next address once the attempt delay has passed, or right away
+    // when nothing is in flight any more (RFC 8305 section 5).
+    quic::QuicTime now = clock_->Now();
+    while (!connection->candidates.empty() &&
+           (connection->attempts.empty() || now >= connection->next_attempt_time))
+    {
+      quic::QuicSocketAddress address = connection->candidates.front();
+      connection->candidates.pop_front();
+      auto attempt = SetupNetworkComponents(address);
+      if (attempt)
+      {
+        connection->attempts.push_back(std::move(attempt));
+        connection->next_attempt_time = now + connection_attempt_delay_;
+        break;
+      }
+    }
 
-    client_->set_enable_web_transport(true);
-    client_->set_use_datagram_contexts(true);
+    if (connection->attempts.empty() && !connection->resolving)
+    {
+      OnConnectionFailed(connection, "Connection initialization failed");
+      return false;
+    }
+    return true;
+  }
+
+  void Client::OnConnectionFailed(Connection *connection, const std::string &error)
+  {
+    connection->failed = true;
+    ScheduleCleanup();
+    std::vector<SessionRequest> queued = std::move(connection->queued);
+    connection->queued.clear();
+    for (size_t i = 0; i < queued.size(); ++i)
+    {
+      OnSessionFailed(connection, error, true);
+    }
+  }
 
-    if (!client_->Initialize() || !client_->Connect())
+  void Client::CreateWebTransportSession(Connection *connection, SessionRequest request)
+  {
+    auto *session = connection->client->client_session();
+    auto *stream = session->CreateOutgoingBidirectionalStream();
+    if (!stream)
     {
-      throw std::runtime_error("Connection initialization failed");
+      // Out of stream credit; keep further sessions off this connection.
+      connection->max_sessions = connection->session_count - 1;
+      OnSessionFailed(connection, "Unable to open a CONNECT stream", true);
+      return;
     }
 
-    StartHandshakeCheck();
+    stream->SendRequest(std::move(request.headers), "", false);
+
+    auto delegate = new SessionReadyAlarmDelegate(this, connection, stream,
+                                                  std::move(request.callback), clock_);
+    connection->session_ready_alarms.emplace_back(alarm_factory_->CreateAlarm(delegate));
+    delegate->SetAlarm(connection->session_ready_alarms.back().get());
+    connection->session_ready_alarms.back()->Set(clock_->Now());
   }
 
-  void Client::StartHandshakeCheck()
+  void Client::OnSessionFailed(Connection *connection, const std::string &error, bool log)
   {
-    auto delegate = new HandshakeAlarmDelegate(this, clock_);
-    handshake_alarm_.reset(alarm_factory_->CreateAlarm(delegate));
-    delegate->SetAlarm(handshake_alarm_.get());
-    handshake_alarm_->Set(clock_->Now());
+    if (session_error_callback_)
+    {
+      session_error_callback_(error);
+    }
+    else if (log)
+    {
+      std::cout << "Session error: " << error << std::endl;
+    }
+    ReleaseSession(connection);
   }
 
-  void Client::CreateWebTransportSession()
+  void Client::OnSessionClosed(uint64_t connection_id)
   {
-    auto *session = client_->client_session();
-    stream_ = session->CreateOutgoingBidirectionalStream();
+    // Gone if the client is disconnecting.
+    Connection *connection = FindConnection(connection_id);
+    if (connection)
+    {
+      ReleaseSession(connection);
+    }
+  }
 
-    quiche::HttpHeaderBlock send_headers = headers_.Clone();
-    stream_->SendRequest(std::move(send_headers), "", false);
+  void Client::ReleaseSession(Connection *connection)
+  {
+    --connection->session_count;
+    ScheduleCleanup();
+    if (--live_sessions_ == 0)
+    {
+      SetConnected(false); // Stop the event loop
+    }
+  }
+
+  void Client::SetConnected(bool connected)
+  {
+    if (connected == connected_)
+    {
+      return;
+    }
+    connected_ = connected;
+    if (connected)
+    {
+      ++context_->active_clients_;
+    }
+    else
+    {
+      --context_->active_clients_;
+    }
+  }
+
+  void Client::ScheduleCleanup()
+  {
+    if (!cleanup_alarm_->IsSet())
+    {
+      cleanup_alarm_->Set(clock_->Now());
+    }
+  }
+
+  void Client::Cleanup()
+  {
+    for (auto &connection : connections_)
+    {
+      auto &alarms = connection->session_ready_alarms;
+      alarms.erase(std::remove_if(alarms.begin(), alarms.end(),
+                                  [](const std::unique_ptr<quic::QuicAlarm> &alarm)
+                                  { return !alarm->IsSet(); }),
+                   alarms.end());
+    }
 
-    auto delegate = new SessionReadyAlarmDelegate(this, stream_, clock_);
-    session_ready_alarm_.reset(alarm_factory_->CreateAlarm(delegate));
-    delegate->SetAlarm(session_ready_alarm_.get());
-    session_ready_alarm_->Set(clock_->Now());
+    // A connection that failed or was closed is never handed out again, so
+    // drop it once its last session is released.
+    connections_.erase(
+        std::remove_if(connections_.begin(), connections_.end(),
+                       [](const std::unique_ptr<Connection> &connection)
+                       {
+                         bool dead = connection->client ? !connection->client->connected()
+                                                        : connection->failed;
+                         return dead && connection->session_count == 0;
+                       }),
+        connections_.end());
   }
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef WEBTRANSPORT_CLIENT_H_
 #define WEBTRANSPORT_CLIENT_H_
 
+#include <deque>
 #include <iostream>
 #include <string>
 #include <memory>
@@ -15,7 +16,6 @@
 #include "quiche/quic/core/quic_alarm_factory.h"
 #include "quiche/quic/tools/quic_default_client.h"
 #include "quiche/quic/tools/quic_url.h"
-#include "quiche/quic/tools/quic_name_lookup.h"
 #include "quiche/quic/platform/api/quic_socket_address.h"
 #include "quiche/common/http/http_header_block.h"
 #include "quiche/quic/core/crypto/proof_verifier.h"
@@ -23,6 +23,7 @@
 #include "quiche/quic/core/quic_versions.h"
 #include "quiche/quic/core/quic_server_id.h"
 #include "quiche/web_transport/web_transport.h"
+#include "web_transport_client_context.h"
 #include "web_transport_client_verify.h"
 
 namespace webtransport
@@ -37,14 +38,30 @@ namespace webtransport
   {
   public:
     explicit Client(const std::string &url);
+    // Attaches the client to a shared context; its connections are then driven
+    // by the context's event loop (ClientContext::run() or poll()).
+    Client(const std::string &url, std::shared_ptr<ClientContext> context);
     ~Client();
 
     // Header management interface
     void setHeader(const std::string &key, const std::string &value);
     void setHeaders(quiche::HttpHeaderBlock headers);
+    // Pins the certificate in `file_path`; it is read and hashed once.
     void setPublicKeyFile(std::string file_path);
+    // Pins the server by the SHA-256 of its leaf certificate or of that
+    // certificate's SubjectPublicKeyInfo (hex, optionally colon separated),
+    // like WebTransport's serverCertificateHashes. Pinned connections skip
+    // CA verification.
+    void addServerCertificateHash(const std::string &sha256_hex);
+    void addServerPublicKeyHash(const std::string &sha256_hex);
     void setCACertBundleFile(std::string file_path);
     void setCACertDir(std::string dir_path);
+    // Re-reads the CA bundle and directory; they are otherwise loaded once
+    // and shared by every handshake of this client.
+    bool reloadCACerts();
+    // Verifies CA chains on the context's worker threads instead of the
+    // event loop thread, so a slow chain doesn't stall other connections.
+    void setAsyncCertificateVerification(bool enabled);
     void connect();
     const quiche::HttpHeaderBlock &getHeaders() const;
 
@@ -56,6 +73,22 @@ namespace webtransport
     void runEventLoop();
     void disconnect();
 
+    // Opens another WebTransport session to `path` on this client's origin.
+    // `headers` are added to the default CONNECT headers. The session reuses an
+    // established QUIC connection while that connection has room for it, and a
+    // new connection is opened otherwise. `callback` defaults to the
+    // onSessionOpen callback.
+    void openSession(const std::string &path, const quiche::HttpHeaderBlock &headers,
+                     std::function<void(ClientSession *)> callback = nullptr);
+
+    // Maximum number of sessions multiplexed over one QUIC connection. The
+    // limit is lowered for a connection whose server answers a CONNECT with 429.
+    void setMaxSessionsPerConnection(size_t max_sessions);
+
+    // Delay before racing the next resolved address while earlier handshakes
+    // are still in flight (RFC 8305 "Connection Attempt Delay").
+    void setConnectionAttemptDelay(uint64_t delay_ms);
+
   private:
     // Delegate for checking handshake progress.
     class HandshakeAlarmDelegate;
@@ -63,32 +96,98 @@ namespace webtransport
     // Delegate for checking session readiness.
     class SessionReadyAlarmDelegate;
 
+    // Delegate dropping finished alarms and dead connections.
+    class CleanupAlarmDelegate;
+
+    // A CONNECT request for one WebTransport session.
+    struct SessionRequest
+    {
+      quiche::HttpHeaderBlock headers;
+      std::function<void(ClientSession *)> callback;
+    };
+
+    // One QUIC connection and the WebTransport sessions multiplexed over it.
+    struct Connection
+    {
+      uint64_t id = 0;
+      // Set once a handshake completes; the winner of the address race.
+      std::unique_ptr<quic::QuicDefaultClient> client;
+      // Resolved addresses not tried yet, in racing order.
+      std::deque<quic::QuicSocketAddress> candidates;
+      // Handshakes racing each other until one of them completes.
+      std::vector<std::unique_ptr<quic::QuicDefaultClient>> attempts;
+      quic::QuicTime next_attempt_time = quic::QuicTime::Zero();
+      // The other address family may still add candidates.
+      bool resolving = true;
+      bool failed = false;
+      std::unique_ptr<quic::QuicAlarm> handshake_alarm;
+      // One per CONNECT still waiting for its response; an alarm that is no
+      // longer set has resolved and is dropped by the next cleanup.
+      std::vector<std::unique_ptr<quic::QuicAlarm>> session_ready_alarms;
+      // Requests waiting for the handshake to complete.
+      std::vector<SessionRequest> queued;
+      // Sessions that are queued, pending or open on this connection.
+      size_t session_count = 0;
+      size_t max_sessions = 0;
+    };
+
     void ParseUrl(const std::string &url_str);
     void SetDefaultHeaders();
-    void SetupNetworkComponents();
-    void StartHandshakeCheck();
-    void CreateWebTransportSession();
+    Connection *AcquireConnection();
+    Connection *FindConnection(uint64_t id);
+    void OnAddressesResolved(Connection *connection,
+                             std::vector<quic::QuicSocketAddress> addresses, bool complete);
+    std::unique_ptr<quic::QuicDefaultClient> SetupNetworkComponents(
+        const quic::QuicSocketAddress &address);
+    void StartHandshakeCheck(Connection *connection);
+    // Advances the address race; returns false once it is decided.
+    bool CheckConnectionAttempts(Connection *connection);
+    void OnConnectionFailed(Connection *connection, const std::string &error);
+    void CreateWebTransportSession(Connection *connection, SessionRequest request);
+    void OnSessionFailed(Connection *connection, const std::string &error, bool log);
+    // Releases the slot of an established session once it closes.
+    void OnSessionClosed(uint64_t connection_id);
+    void ReleaseSession(Connection *connection);
+    // Alarms and connections can't be destroyed from their own callbacks, so
+    // they are dropped from a separate alarm.
+    void ScheduleCleanup();
+    void Cleanup();
+    // Destroys the connections; sessions closing with them find no
+    // connection to release.
+    void CloseConnections();
+    void SetConnected(bool connected);
 
     std::string ca_cert_dir;
     std::string ca_cert_bundle_path;
     std::string public_key_file;
-    std::unique_ptr<quic::QuicEventLoop> event_loop_;
+    // Replaced rather than modified, since verifiers share it.
+    std::shared_ptr<const CertificatePins> pins_;
+    std::shared_ptr<CertificateTrustStore> trust_store_;
+    bool async_verification_ = false;
+    std::shared_ptr<ClientContext> context_;
+    quic::QuicEventLoop *event_loop_;
     const quic::QuicClock *clock_;
-    std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+    quic::QuicAlarmFactory *alarm_factory_;
+    std::unique_ptr<quic::QuicAlarm> cleanup_alarm_;
     quic::QuicUrl url_;
     quiche::HttpHeaderBlock headers_;
-    std::unique_ptr<quic::QuicDefaultClient> client_;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    uint64_t next_connection_id_ = 1;
+    size_t max_sessions_per_connection_ = 16;
+    quic::QuicTime::Delta connection_attempt_delay_ = quic::QuicTime::Delta::FromMilliseconds(250);
+    // Lets resolver callbacks detect that the client is gone.
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+    // Sessions that are queued, pending or open across all connections.
+    size_t live_sessions_ = 0;
     quic::QuicSocketAddress server_address_;
-    quic::QuicSpdyClientStream *stream_ = nullptr;
-    bool connected_ = true;
+    bool connected_ = false;
     std::function<void(ClientSession *)> session_callback_;
     std::function<void(ClientSession *, ClientBidirectionalStream *)> bidi_stream_callback_;
     std::function<void(std::string)> session_error_callback_;
-    std::unique_ptr<quic::QuicAlarm> handshake_alarm_;
-    std::unique_ptr<quic::QuicAlarm> session_ready_alarm_;
 
     friend class HandshakeAlarmDelegate;
     friend class SessionReadyAlarmDelegate;
+    friend class CleanupAlarmDelegate;
   };
 
 } // namespace webtransport
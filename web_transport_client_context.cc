@@ -0,0 +1,98 @@
+#include "web_transport_client_context.h"
+
+#include <utility>
+#include "quiche/quic/core/io/quic_default_event_loop.h"
+#include "quiche/quic/core/quic_default_clock.h"
+#include "quiche/quic/core/quic_time.h"
+
+namespace webtransport
+{
+
+  namespace
+  {
+
+    // Forwards to the context's session cache. QuicDefaultClient takes
+    // ownership of its cache, so each connection gets one of these.
+    class SharedSessionCache : public quic::SessionCache
+    {
+    public:
+      explicit SharedSessionCache(quic::SessionCache *cache) : cache_(cache) {}
+
+      void Insert(const quic::QuicServerId &server_id,
+                  bssl::UniquePtr<SSL_SESSION> session,
+                  const quic::TransportParameters &params,
+                  const quic::ApplicationState *application_state) override
+      {
+        cache_->Insert(server_id, std::move(session), params, application_state);
+      }
+
+      std::unique_ptr<quic::QuicResumptionState> Lookup(
+          const quic::QuicServerId &server_id, quic::QuicWallTime now,
+          const SSL_CTX *ctx) override
+      {
+        return cache_->Lookup(server_id, now, ctx);
+      }
+
+      void ClearEarlyData(const quic::QuicServerId &server_id) override
+      {
+        cache_->ClearEarlyData(server_id);
+      }
+
+      void OnNewTokenReceived(const quic::QuicServerId &server_id,
+                              absl::string_view token) override
+      {
+        cache_->OnNewTokenReceived(server_id, token);
+      }
+
+      void RemoveExpiredEntries(quic::QuicWallTime now) override
+      {
+        cache_->RemoveExpiredEntries(now);
+      }
+
+      void Clear() override { cache_->Clear(); }
+
+    private:
+      quic::SessionCache *cache_;
+    };
+
+  } // namespace
+
+  ClientContext::ClientContext()
+  {
+    event_loop_ = quic::GetDefaultEventLoop()->Create(quic::QuicDefaultClock::Get());
+    clock_ = event_loop_->GetClock();
+    alarm_factory_ = event_loop_->CreateAlarmFactory();
+    resolver_ = std::make_unique<ClientResolver>(alarm_factory_.get(), clock_);
+  }
+
+  ClientContext::~ClientContext() = default;
+
+  VerificationPool *ClientContext::verification_pool()
+  {
+    if (!verification_pool_)
+    {
+      verification_pool_ = std::make_unique<VerificationPool>(alarm_factory_.get(), clock_);
+    }
+    return verification_pool_.get();
+  }
+
+  std::unique_ptr<quic::SessionCache> ClientContext::CreateSessionCache()
+  {
+    return std::make_unique<SharedSessionCache>(&session_cache_);
+  }
+
+  void ClientContext::run()
+  {
+    stopped_ = false;
+    while (!stopped_ && active_clients_ > 0)
+    {
+      event_loop_->RunEventLoopOnce(quic::QuicTime::Delta::FromMilliseconds(50));
+    }
+  }
+
+  void ClientContext::poll(uint64_t timeout_ms)
+  {
+    event_loop_->RunEventLoopOnce(quic::QuicTime::Delta::FromMilliseconds(timeout_ms));
+  }
+
+} // namespace webtransport
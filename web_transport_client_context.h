@@ -0,0 +1,72 @@
+#ifndef WEBTRANSPORT_CLIENT_CONTEXT_H_
+#define WEBTRANSPORT_CLIENT_CONTEXT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/crypto/quic_client_session_cache.h"
+#include "quiche/quic/core/io/quic_event_loop.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "web_transport_client_resolver.h"
+#include "web_transport_client_verify.h"
+
+namespace webtransport
+{
+
+  // ClientContext holds the event loop, alarm factory, clock, DNS resolver
+  // and TLS session cache shared by any number of Clients. A single thread
+  // drives every connection of every attached Client through run() or poll().
+  class ClientContext
+  {
+  public:
+    ClientContext();
+    ~ClientContext();
+
+    ClientContext(const ClientContext &) = delete;
+    ClientContext &operator=(const ClientContext &) = delete;
+
+    quic::QuicEventLoop *event_loop() { return event_loop_.get(); }
+    quic::QuicAlarmFactory *alarm_factory() { return alarm_factory_.get(); }
+    const quic::QuicClock *clock() const { return clock_; }
+    ClientResolver *resolver() { return resolver_.get(); }
+
+    // Worker threads for off-loop certificate verification, started on first
+    // use.
+    VerificationPool *verification_pool();
+
+    // Returns a session cache for one connection. All returned caches share
+    // the context's storage, so any connection can resume a session that
+    // another connection established.
+    std::unique_ptr<quic::SessionCache> CreateSessionCache();
+
+    // Runs the event loop until stop() is called or no attached Client is
+    // connected any more.
+    void run();
+
+    // Processes pending events, waiting at most `timeout_ms` for new ones.
+    void poll(uint64_t timeout_ms = 0);
+
+    // Makes run() return after the current iteration.
+    void stop() { stopped_ = true; }
+
+    // Number of attached Clients that are connected or connecting.
+    size_t active_clients() const { return active_clients_; }
+
+  private:
+    friend class Client;
+
+    std::unique_ptr<quic::QuicEventLoop> event_loop_;
+    const quic::QuicClock *clock_;
+    std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+    std::unique_ptr<ClientResolver> resolver_;
+    std::unique_ptr<VerificationPool> verification_pool_;
+    quic::QuicClientSessionCache session_cache_;
+    size_t active_clients_ = 0;
+    bool stopped_ = false;
+  };
+
+} // namespace webtransport
+
+#endif // WEBTRANSPORT_CLIENT_CONTEXT_H_
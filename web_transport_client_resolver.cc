@@ -0,0 +1,258 @@
+#include "web_transport_client_resolver.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#endif
+
+#include <cstring>
+#include "absl/strings/str_cat.h"
+
+namespace webtransport
+{
+
+  namespace
+  {
+
+    // How often pending lookups are checked for completion.
+    constexpr int64_t kPollIntervalMs = 2;
+
+    std::vector<quic::QuicSocketAddress> LookupFamily(const std::string &host, uint16_t port,
+                                                      int family)
+    {
+      std::vector<quic::QuicSocketAddress> addresses;
+      addrinfo hints;
+      std::memset(&hints, 0, sizeof(hints));
+      hints.ai_family = family;
+      hints.ai_socktype = SOCK_DGRAM;
+      hints.ai_protocol = IPPROTO_UDP;
+
+      addrinfo *info_list = nullptr;
+      std::string service = std::to_string(port);
+      if (getaddrinfo(host.c_str(), service.c_str(), &hints, &info_list) != 0)
+      {
+        return addresses;
+      }
+      for (addrinfo *info = info_list; info != nullptr; info = info->ai_next)
+      {
+        addresses.emplace_back(info->ai_addr, static_cast<socklen_t>(info->ai_addrlen));
+      }
+      freeaddrinfo(info_list);
+      return addresses;
+    }
+
+  } // namespace
+
+  class ClientResolver::PollAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+  {
+  public:
+    explicit PollAlarmDelegate(ClientResolver *resolver) : resolver_(resolver) {}
+
+    void OnAlarm() override { resolver_->DeliverResults(); }
+
+  private:
+    ClientResolver *resolver_;
+  };
+
+  ClientResolver::ClientResolver(quic::QuicAlarmFactory *alarm_factory,
+                                 const quic::QuicClock *clock)
+      : clock_(clock),
+        poll_alarm_(alarm_factory->CreateAlarm(new PollAlarmDelegate(this))) {}
+
+  ClientResolver::~ClientResolver()
+  {
+    poll_alarm_->Cancel();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      queries_.clear();
+    }
+    queries_cv_.notify_all();
+    for (auto &worker : workers_)
+    {
+      worker.join();
+    }
+  }
+
+  void ClientResolver::WorkerLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      queries_cv_.wait(lock, [this]()
+                       { return stopping_ || !queries_.empty(); });
+      if (stopping_)
+      {
+        return;
+      }
+      Query query = std::move(queries_.front());
+      queries_.pop_front();
+      lock.unlock();
+      auto addresses = LookupFamily(query.host, query.port, query.family);
+      lock.lock();
+      answers_.push_back(Answer{std::move(query.key), query.family, std::move(addresses)});
+    }
+  }
+
+  void ClientResolver::Resolve(const std::string &host, uint16_t port, Callback callback)
+  {
+    std::string key = absl::StrCat(host, ":", port);
+
+    auto cached = cache_.find(key);
+    if (cached != cache_.end())
+    {
+      if (clock_->ApproximateNow() < cached->second.expiry)
+      {
+        callback(cached->second.addresses, true);
+        return;
+      }
+      cache_.erase(cached);
+    }
+
+    auto [it, inserted] = lookups_.try_emplace(key);
+    Lookup &lookup = it->second;
+    lookup.callbacks.push_back(callback);
+    if (!inserted)
+    {
+      // Already in flight; catch up with what earlier callers received.
+      if (!lookup.delivered.empty())
+      {
+        callback(lookup.delivered, false);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (workers_.size() < kWorkerThreads)
+      {
+        workers_.emplace_back(&ClientResolver::WorkerLoop, this);
+      }
+      queries_.push_back(Query{key, host, port, AF_INET6});
+      queries_.push_back(Query{key, host, port, AF_INET});
+    }
+    queries_cv_.notify_all();
+
+    if (!poll_alarm_->IsSet())
+    {
+      poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+    }
+  }
+
+  void ClientResolver::DeliverResults()
+  {
+    std::vector<Answer> answers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      answers.swap(answers_);
+    }
+
+    quic::QuicTime now = clock_->ApproximateNow();
+    for (auto &answer : answers)
+    {
+      auto it = lookups_.find(answer.key);
+      if (it == lookups_.end())
+      {
+        continue;
+      }
+      Lookup &lookup = it->second;
+      if (answer.family == AF_INET6)
+      {
+        lookup.v6 = std::move(answer.addresses);
+        lookup.v6_answered = true;
+      }
+      else
+      {
+        lookup.v4 = std::move(answer.addresses);
+        lookup.v4_answered = true;
+        lookup.v4_deadline = now + quic::QuicTime::Delta::FromMilliseconds(kResolutionDelayMs);
+      }
+    }
+
+    for (auto it = lookups_.begin(); it != lookups_.end();)
+    {
+      Lookup &lookup = it->second;
+      std::vector<quic::QuicSocketAddress> batch;
+      if (lookup.v6_answered && !lookup.v6_delivered)
+      {
+        lookup.v6_delivered = true;
+        batch = lookup.v6;
+      }
+      if (lookup.v4_answered && !lookup.v4_delivered &&
+          (lookup.v6_answered || now >= lookup.v4_deadline))
+      {
+        lookup.v4_delivered = true;
+        batch.insert(batch.end(), lookup.v4.begin(), lookup.v4.end());
+      }
+      bool complete = lookup.v6_delivered && lookup.v4_delivered;
+      if (batch.empty() && !complete)
+      {
+        ++it;
+        continue;
+      }
+
+      lookup.delivered.insert(lookup.delivered.end(), batch.begin(), batch.end());
+      // Copied: a callback may start another lookup.
+      std::vector<Callback> callbacks = lookup.callbacks;
+      if (complete)
+      {
+        if (!lookup.delivered.empty())
+        {
+          cache_[it->first] = CacheEntry{lookup.delivered, now + ttl_};
+        }
+        it = lookups_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+      for (auto &callback : callbacks)
+      {
+        callback(batch, complete);
+      }
+    }
+
+    if (!lookups_.empty() && !poll_alarm_->IsSet())
+    {
+      poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+    }
+  }
+
+  std::vector<quic::QuicSocketAddress> ClientResolver::SortForRacing(
+      const std::vector<quic::QuicSocketAddress> &addresses)
+  {
+    std::vector<quic::QuicSocketAddress> v6;
+    std::vector<quic::QuicSocketAddress> v4;
+    for (const auto &address : addresses)
+    {
+      if (address.host().IsIPv6())
+      {
+        v6.push_back(address);
+      }
+      else
+      {
+        v4.push_back(address);
+      }
+    }
+
+    std::vector<quic::QuicSocketAddress> sorted;
+    sorted.reserve(addresses.size());
+    for (size_t i = 0; i < v6.size() || i < v4.size(); ++i)
+    {
+      if (i < v6.size())
+      {
+        sorted.push_back(v6[i]);
+      }
+      if (i < v4.size())
+      {
+        sorted.push_back(v4[i]);
+      }
+    }
+    return sorted;
+  }
+
+} // namespace webtransport
@@ -0,0 +1,118 @@
+#ifndef WEBTRANSPORT_CLIENT_RESOLVER_H_
+#define WEBTRANSPORT_CLIENT_RESOLVER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "quiche/quic/core/quic_alarm.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+
+namespace webtransport
+{
+
+  // ClientResolver resolves host names without blocking the event loop.
+  // The IPv6 and IPv4 addresses of a host are looked up separately on a
+  // small pool of worker threads, so a slow answer for one family does not
+  // hold up the other. Results are handed back on the event loop thread and
+  // cached for a short TTL.
+  class ClientResolver
+  {
+  public:
+    // Receives addresses as each family's answer is handed back; the last
+    // call has `complete` set. No addresses over all calls means the lookup
+    // failed.
+    using Callback = std::function<void(std::vector<quic::QuicSocketAddress> addresses, bool complete)>;
+
+    static constexpr size_t kWorkerThreads = 4;
+    // How long IPv4 answers wait for a pending IPv6 answer (RFC 8305
+    // section 3, "Resolution Delay").
+    static constexpr int64_t kResolutionDelayMs = 50;
+
+    ClientResolver(quic::QuicAlarmFactory *alarm_factory, const quic::QuicClock *clock);
+    // Joins the workers, which may wait for lookups in progress.
+    ~ClientResolver();
+
+    // Resolves `host`:`port` to its IPv6 and IPv4 addresses. `callback` runs
+    // on the event loop thread, synchronously on a cache hit or for the
+    // addresses an earlier caller already received.
+    void Resolve(const std::string &host, uint16_t port, Callback callback);
+
+    void set_ttl(quic::QuicTime::Delta ttl) { ttl_ = ttl; }
+
+    // Orders addresses as RFC 8305 section 4 recommends: families interleaved,
+    // starting with IPv6.
+    static std::vector<quic::QuicSocketAddress> SortForRacing(
+        const std::vector<quic::QuicSocketAddress> &addresses);
+
+  private:
+    class PollAlarmDelegate;
+
+    struct CacheEntry
+    {
+      std::vector<quic::QuicSocketAddress> addresses;
+      quic::QuicTime expiry = quic::QuicTime::Zero();
+    };
+
+    // One getaddrinfo() call for one address family.
+    struct Query
+    {
+      std::string key;
+      std::string host;
+      uint16_t port = 0;
+      int family = 0;
+    };
+
+    struct Answer
+    {
+      std::string key;
+      int family = 0;
+      std::vector<quic::QuicSocketAddress> addresses;
+    };
+
+    // A lookup in flight, keyed like cache_.
+    struct Lookup
+    {
+      std::vector<Callback> callbacks;
+      // Handed to the callbacks so far.
+      std::vector<quic::QuicSocketAddress> delivered;
+      std::vector<quic::QuicSocketAddress> v6;
+      std::vector<quic::QuicSocketAddress> v4;
+      bool v6_answered = false;
+      bool v4_answered = false;
+      bool v6_delivered = false;
+      bool v4_delivered = false;
+      quic::QuicTime v4_deadline = quic::QuicTime::Zero();
+    };
+
+    void WorkerLoop();
+    void DeliverResults();
+
+    const quic::QuicClock *clock_;
+    std::unique_ptr<quic::QuicAlarm> poll_alarm_;
+    quic::QuicTime::Delta ttl_ = quic::QuicTime::Delta::FromSeconds(30);
+    std::map<std::string, CacheEntry> cache_;
+    std::map<std::string, Lookup> lookups_;
+
+    // Shared with the workers, which are started by the first lookup.
+    std::mutex mutex_;
+    std::condition_variable queries_cv_;
+    std::deque<Query> queries_;
+    std::vector<Answer> answers_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+  };
+
+} // namespace webtransport
+
+#endif // WEBTRANSPORT_CLIENT_RESOLVER_H_
@@ -14,6 +14,27 @@ namespace webtransport
     session_->SetVisitor(std::make_unique<ClientSessionVisitor>(this));
   }
 
+  ClientSession::~ClientSession()
+  {
+    NotifyClosed();
+  }
+
+  void ClientSession::NotifyClosed()
+  {
+    if (release_callback_)
+    {
+      auto callback = std::move(release_callback_);
+      release_callback_ = nullptr;
+      callback();
+    }
+    if (close_callback_)
+    {
+      auto callback = std::move(close_callback_);
+      close_callback_ = nullptr;
+      callback();
+    }
+  }
+
   ClientBidirectionalStream *ClientSession::createBidirectionalStream()
   {
     auto stream = session_->OpenOutgoingBidirectionalStream();
@@ -26,6 +47,12 @@ namespace webtransport
     session_->SendOrQueueDatagram(payload);
   }
 
+  void ClientSession::SendDatagram(const std::shared_ptr<const std::vector<uint8_t>> &data)
+  {
+    session_->SendOrQueueDatagram(absl::string_view(
+        reinterpret_cast<const char *>(data->data()), data->size()));
+  }
+
   void ClientSession::setInterval(uint64_t interval_ms, std::function<void()> callback)
   {
     auto delegate = new ClientIntervalAlarmDelegate(clock_, interval_ms, std::move(callback));
@@ -46,6 +73,7 @@ namespace webtransport
     {
       std::cout << "Session closed: " << error_message << std::endl;
     }
+    NotifyClosed();
   }
 
   void ClientSession::OnDatagramReceived(absl::string_view datagram)
@@ -90,10 +118,25 @@ namespace webtransport
     session_error_callback_ = std::move(callback);
   }
 
+  void ClientSession::onClose(std::function<void()> callback)
+  {
+    close_callback_ = std::move(callback);
+  }
+
+  void ClientSession::setReleaseCallback(std::function<void()> callback)
+  {
+    release_callback_ = std::move(callback);
+  }
+
   // ClientSessionVisitor implementation
   ClientSessionVisitor::ClientSessionVisitor(ClientSession *session)
       : session_(session) {}
 
+  ClientSessionVisitor::~ClientSessionVisitor()
+  {
+    delete session_;
+  }
+
   void ClientSessionVisitor::OnSessionReady() {}
 
   void ClientSessionVisitor::OnSessionClosed(webtransport::SessionErrorCode error_code,
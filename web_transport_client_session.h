@@ -5,6 +5,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/http/web_transport_http3.h"
@@ -19,16 +20,21 @@ namespace webtransport
   class ClientBidirectionalStream;
   class ClientSessionVisitor;
 
-  // ClientSession implementation with error callback support
+  // ClientSession implementation with error callback support. Owned by its
+  // visitor, so it is destroyed together with the quiche session.
   class ClientSession
   {
   public:
     explicit ClientSession(quic::WebTransportHttp3 *session,
                            quic::QuicAlarmFactory *alarm_factory,
                            const quic::QuicClock *clock);
+    ~ClientSession();
 
     ClientBidirectionalStream *createBidirectionalStream();
     void SendDatagram(const std::vector<uint8_t> &data);
+    // Datagrams are framed per session, so quiche copies the payload once
+    // either way; this saves building a vector per recipient.
+    void SendDatagram(const std::shared_ptr<const std::vector<uint8_t>> &data);
     void setInterval(uint64_t interval_ms, std::function<void()> callback);
 
     // When the session is closed (e.g. rejected by the server),
@@ -45,6 +51,20 @@ namespace webtransport
     // New function: register error callback for session errors.
     void setErrorCallback(std::function<void(std::string)> callback);
 
+    // Called once when the session closes. Drop any pointer to it, or to its
+    // handle: both are destroyed shortly after.
+    void onClose(std::function<void()> callback);
+
+    // Called once when the session closes, before the onClose callback.
+    // Reserved for the Client that opened the session, which uses it to free
+    // the session's slot on its connection.
+    void setReleaseCallback(std::function<void()> callback);
+
+    // Object owned on behalf of the caller and destroyed with the session,
+    // e.g. the public API's wrapper.
+    void *handle() const { return handle_.get(); }
+    void setHandle(std::shared_ptr<void> handle) { handle_ = std::move(handle); }
+
   private:
     quic::WebTransportHttp3 *session_;
     quic::QuicAlarmFactory *alarm_factory_;
@@ -53,6 +73,11 @@ namespace webtransport
     std::function<void(std::vector<uint8_t>)> datagram_callback_;
     std::function<void(ClientSession *, ClientBidirectionalStream *)> bidi_stream_callback_;
     std::function<void(std::string)> session_error_callback_;
+    std::function<void()> close_callback_;
+    std::function<void()> release_callback_;
+    std::shared_ptr<void> handle_;
+
+    void NotifyClosed();
   };
 
   // ClientSession Visitor
@@ -60,6 +85,7 @@ namespace webtransport
   {
   public:
     explicit ClientSessionVisitor(ClientSession *session);
+    ~ClientSessionVisitor() override;
 
     void OnSessionReady() override;
     void OnSessionClosed(webtransport::SessionErrorCode error_code,
@@ -1,5 +1,8 @@
 #include "web_transport_client_stream.h"
 #include "web_transport_client_interval.h"
+#include "absl/types/span.h"
+#include "quiche/common/platform/api/quiche_mem_slice.h"
+#include "quiche/common/quiche_stream.h"
 
 namespace webtransport
 {
@@ -12,12 +15,32 @@ namespace webtransport
     stream_->SetVisitor(std::make_unique<ClientStreamVisitor>(this));
   }
 
+  ClientBidirectionalStream::~ClientBidirectionalStream()
+  {
+    if (close_callback_)
+    {
+      close_callback_();
+    }
+  }
+
   bool ClientBidirectionalStream::Send(const std::vector<uint8_t> &data)
   {
     std::string payload(data.begin(), data.end());
     return stream_->Write(payload);
   }
 
+  bool ClientBidirectionalStream::Send(std::shared_ptr<const std::vector<uint8_t>> data)
+  {
+    if (!data || data->empty())
+    {
+      return true;
+    }
+    const char *bytes = reinterpret_cast<const char *>(data->data());
+    size_t size = data->size();
+    quiche::QuicheMemSlice slice(quiche::QuicheMemSlice::InPlace(), std::move(data), bytes, size);
+    return stream_->Writev(absl::MakeSpan(&slice, 1), quiche::StreamWriteOptions()).ok();
+  }
+
   void ClientBidirectionalStream::onStreamRead(std::function<void(std::vector<uint8_t>)> callback)
   {
     read_callback_ = std::move(callback);
@@ -32,6 +55,72 @@ namespace webtransport
                          quic::QuicTime::Delta::FromMilliseconds(interval_ms));
   }
 
+  bool ClientBidirectionalStream::Close()
+  {
+    return stream_->SendFin();
+  }
+
+  void ClientBidirectionalStream::Reset(uint64_t error_code)
+  {
+    auto code = static_cast<quic::WebTransportStreamError>(error_code);
+    stream_->ResetWithUserCode(code);
+    stream_->SendStopSending(code);
+  }
+
+  void ClientBidirectionalStream::onFin(std::function<void()> callback)
+  {
+    fin_callback_ = std::move(callback);
+  }
+
+  void ClientBidirectionalStream::onReset(std::function<void(uint64_t)> callback)
+  {
+    reset_callback_ = std::move(callback);
+  }
+
+  void ClientBidirectionalStream::onStopSending(std::function<void(uint64_t)> callback)
+  {
+    stop_sending_callback_ = std::move(callback);
+  }
+
+  // Nothing more will be read after a FIN or reset, so the read callbacks
+  // are released right away instead of when the stream is destroyed.
+  void ClientBidirectionalStream::NotifyFin()
+  {
+    auto callback = std::move(fin_callback_);
+    read_callback_ = nullptr;
+    fin_callback_ = nullptr;
+    reset_callback_ = nullptr;
+    if (callback)
+    {
+      callback();
+    }
+  }
+
+  void ClientBidirectionalStream::NotifyReset(uint64_t error_code)
+  {
+    auto callback = std::move(reset_callback_);
+    read_callback_ = nullptr;
+    fin_callback_ = nullptr;
+    reset_callback_ = nullptr;
+    if (callback)
+    {
+      callback(error_code);
+    }
+  }
+
+  void ClientBidirectionalStream::NotifyStopSending(uint64_t error_code)
+  {
+    if (stop_sending_callback_)
+    {
+      stop_sending_callback_(error_code);
+    }
+  }
+
+  void ClientBidirectionalStream::onClose(std::function<void()> callback)
+  {
+    close_callback_ = std::move(callback);
+  }
+
   quic::WebTransportStream *ClientBidirectionalStream::getStream()
   {
     return stream_;
@@ -46,6 +135,11 @@ namespace webtransport
   ClientStreamVisitor::ClientStreamVisitor(ClientBidirectionalStream *stream)
       : stream_(stream) {}
 
+  ClientStreamVisitor::~ClientStreamVisitor()
+  {
+    delete stream_;
+  }
+
       void ClientStreamVisitor::OnCanRead() {
         if (!stream_) {
             return;
@@ -62,6 +156,9 @@ namespace webtransport
               std::cerr << "Stream FIN received (no data)." << std::endl;
               stream_->getReadCallback()({});
           }
+          if (fin) {
+              stream_->NotifyFin();
+          }
           return;
         }
     
@@ -115,13 +212,24 @@ namespace webtransport
                 stream_->getReadCallback()({}); // fin, but no data
             }
         }
+        if (fin_received) {
+            stream_->NotifyFin();
+        }
     }
 
   void ClientStreamVisitor::OnCanWrite() {}
 
-  void ClientStreamVisitor::OnResetStreamReceived(quic::WebTransportStreamError error) {}
+  void ClientStreamVisitor::OnResetStreamReceived(quic::WebTransportStreamError error)
+  {
+    if (stream_)
+      stream_->NotifyReset(error);
+  }
 
-  void ClientStreamVisitor::OnStopSendingReceived(quic::WebTransportStreamError error) {}
+  void ClientStreamVisitor::OnStopSendingReceived(quic::WebTransportStreamError error)
+  {
+    if (stream_)
+      stream_->NotifyStopSending(error);
+  }
 
   void ClientStreamVisitor::OnWriteSideInDataRecvdState() {}
 
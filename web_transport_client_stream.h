@@ -20,19 +20,44 @@ namespace webtransport
   // Forward declarations
   class ClientStreamVisitor;
 
-  // ClientBidirectionalStream declaration
+  // ClientBidirectionalStream declaration. Owned by its visitor, so it is
+  // destroyed together with the quiche stream.
   class ClientBidirectionalStream
   {
   public:
     explicit ClientBidirectionalStream(quic::WebTransportStream *stream,
                                        quic::QuicAlarmFactory *alarm_factory,
                                        const quic::QuicClock *clock);
-    ~ClientBidirectionalStream() = default;
+    ~ClientBidirectionalStream();
 
     bool Send(const std::vector<uint8_t> &data);
+    // Queues `data` without copying it; the stream holds a reference until
+    // the bytes are acknowledged, so one buffer can go to many streams.
+    bool Send(std::shared_ptr<const std::vector<uint8_t>> data);
     void onStreamRead(std::function<void(std::vector<uint8_t>)> callback);
     void setInterval(uint64_t interval_ms, std::function<void()> callback);
 
+    // Sends a FIN after the data written so far.
+    bool Close();
+    // Aborts the stream in both directions with `error_code`.
+    void Reset(uint64_t error_code);
+
+    // The peer finished sending. The read callbacks are released afterwards.
+    void onFin(std::function<void()> callback);
+    // The peer aborted its side (RESET_STREAM) or asked us to stop sending
+    // (STOP_SENDING).
+    void onReset(std::function<void(uint64_t)> callback);
+    void onStopSending(std::function<void(uint64_t)> callback);
+
+    // Called once when quiche destroys the stream. Drop any pointer to it, or
+    // to its handle, from here on.
+    void onClose(std::function<void()> callback);
+
+    // Object owned on behalf of the caller and destroyed with the stream,
+    // e.g. the public API's wrapper.
+    void *handle() const { return handle_.get(); }
+    void setHandle(std::shared_ptr<void> handle) { handle_ = std::move(handle); }
+
     // Make these methods public so ClientStreamVisitor can access them
     quic::WebTransportStream *getStream();
     std::function<void(std::vector<uint8_t>)> &getReadCallback();
@@ -55,11 +80,21 @@ namespace webtransport
 
   private:
     friend class ClientStreamVisitor;
+
+    void NotifyFin();
+    void NotifyReset(uint64_t error_code);
+    void NotifyStopSending(uint64_t error_code);
+
     quic::WebTransportStream *stream_;
     quic::QuicAlarmFactory *alarm_factory_;
     const quic::QuicClock *clock_;
     std::unique_ptr<quic::QuicAlarm> interval_alarm_;
     std::function<void(std::vector<uint8_t>)> read_callback_;
+    std::function<void()> fin_callback_;
+    std::function<void(uint64_t)> reset_callback_;
+    std::function<void(uint64_t)> stop_sending_callback_;
+    std::function<void()> close_callback_;
+    std::shared_ptr<void> handle_;
   };
 
   // ClientStreamVisitor declaration
@@ -67,6 +102,7 @@ namespace webtransport
   {
   public:
     explicit ClientStreamVisitor(ClientBidirectionalStream *stream);
+    ~ClientStreamVisitor() override;
 
     void OnCanRead() override;
     void OnCanWrite() override;
@@ -2,6 +2,7 @@
 
 #include <openssl/bio.h>
 #include <openssl/pem.h>
+#include <openssl/sha.h>
 #include <openssl/ssl.h>
 #include <openssl/x509_vfy.h>
 #include <iostream>
@@ -10,11 +11,15 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <utility>
 
 // Anonymous namespace for helper functions.
 namespace
 {
 
+  // How often the verification pool is checked for finished work.
+  constexpr int64_t kPollIntervalMs = 2;
+
   // Helper to load a certificate from a string (supports PEM or DER).
   X509 *LoadCertificate(const std::string &cert_str)
   {
@@ -47,53 +52,203 @@ namespace
     return true;
   }
 
+  std::string Sha256(absl::string_view data)
+  {
+    std::string digest(SHA256_DIGEST_LENGTH, '\0');
+    SHA256(reinterpret_cast<const uint8_t *>(data.data()), data.size(),
+           reinterpret_cast<uint8_t *>(&digest[0]));
+    return digest;
+  }
+
+  // Accepts 64 hex digits, optionally separated by colons as printed by
+  // `openssl x509 -fingerprint -sha256`.
+  bool ParseSha256Hex(const std::string &hex, std::string *out)
+  {
+    auto nibble = [](char c) -> int
+    {
+      if (c >= '0' && c <= '9')
+        return c - '0';
+      if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+      return -1;
+    };
+
+    std::string digits;
+    for (char c : hex)
+    {
+      if (c != ':')
+      {
+        digits.push_back(c);
+      }
+    }
+    if (digits.size() != 2 * SHA256_DIGEST_LENGTH)
+    {
+      return false;
+    }
+
+    out->clear();
+    for (size_t i = 0; i < digits.size(); i += 2)
+    {
+      int high = nibble(digits[i]);
+      int low = nibble(digits[i + 1]);
+      if (high < 0 || low < 0)
+      {
+        return false;
+      }
+      out->push_back(static_cast<char>((high << 4) | low));
+    }
+    return true;
+  }
+
+  // Earliest notAfter of the chain as POSIX time, or 0 if it can't be read.
+  int64_t ChainNotAfter(const std::vector<X509 *> &chain)
+  {
+    int64_t earliest = 0;
+    for (X509 *cert : chain)
+    {
+      int64_t not_after = 0;
+      if (ASN1_TIME_to_posix(X509_get0_notAfter(cert), &not_after) != 1)
+      {
+        return 0;
+      }
+      if (earliest == 0 || not_after < earliest)
+      {
+        earliest = not_after;
+      }
+    }
+    return earliest;
+  }
+
 } // namespace
 
 namespace webtransport
 {
 
-  BoringSSLProofVerifier::BoringSSLProofVerifier()
-      : public_key_file_(""),
-        ca_cert_bundle_path_(""),
-        ca_cert_dir_(""),
-        use_public_key_(false) {}
-
-  BoringSSLProofVerifier::BoringSSLProofVerifier(
-      const std::string &public_key_file,
-      const std::string &ca_cert_bundle_path,
-      const std::string &ca_cert_dir)
-      : public_key_file_(public_key_file),
-        ca_cert_bundle_path_(ca_cert_bundle_path),
+  CertificateTrustStore::CertificateTrustStore(const std::string &ca_cert_bundle_path,
+                                               const std::string &ca_cert_dir,
+                                               size_t max_cached_results)
+      : ca_cert_bundle_path_(ca_cert_bundle_path),
         ca_cert_dir_(ca_cert_dir),
-        use_public_key_(!public_key_file.empty()) {}
+        max_cached_results_(max_cached_results)
+  {
+    Reload();
+  }
 
-  // This method is a stub that simply prints a message and returns success.
-  quic::QuicAsyncStatus BoringSSLProofVerifier::VerifyProof(
-      const std::string &hostname, const uint16_t port,
-      const std::string &server_config, quic::QuicTransportVersion transport_version,
-      absl::string_view chlo_hash, const std::vector<std::string> &certs,
-      const std::string &cert_sct, const std::string &signature,
-      const quic::ProofVerifyContext *context, std::string *error_details,
-      std::unique_ptr<quic::ProofVerifyDetails> *details,
-      std::unique_ptr<quic::ProofVerifierCallback> callback)
+  bool CertificateTrustStore::Reload()
   {
-    std::cerr << "[+] Checking VerifyProof instead" << std::endl;
-    return quic::QUIC_SUCCESS;
+    bssl::UniquePtr<X509_STORE> store(X509_STORE_new());
+    if (!store)
+    {
+      std::cerr << "Failed to create X509_STORE." << std::endl;
+      return false;
+    }
+
+    // Use provided CA bundle/directory if available, else use default paths.
+    if (!ca_cert_bundle_path_.empty() || !ca_cert_dir_.empty())
+    {
+      if (X509_STORE_load_locations(
+              store.get(),
+              ca_cert_bundle_path_.empty() ? nullptr : ca_cert_bundle_path_.c_str(),
+              ca_cert_dir_.empty() ? nullptr : ca_cert_dir_.c_str()) != 1)
+      {
+        std::cerr << "Failed to load CA certificates from specified locations." << std::endl;
+        return false;
+      }
+    }
+    else if (X509_STORE_set_default_paths(store.get()) != 1)
+    {
+      std::cerr << "Failed to set default paths on X509_STORE." << std::endl;
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    store_ = std::move(store);
+    results_.clear();
+    results_index_.clear();
+    return true;
   }
 
-  quic::QuicAsyncStatus BoringSSLProofVerifier::VerifyCertChain(
-      const std::string &hostname, const uint16_t port,
-      const std::vector<std::string> &certs, const std::string &ocsp_response,
-      const std::string &cert_sct, const quic::ProofVerifyContext *context,
-      std::string *error_details, std::unique_ptr<quic::ProofVerifyDetails> *details,
-      uint8_t *out_alert, std::unique_ptr<quic::ProofVerifierCallback> callback)
+  bssl::UniquePtr<X509_STORE> CertificateTrustStore::GetStore()
   {
-    if (certs.empty())
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!store_)
     {
-      std::cerr << "No certificates provided." << std::endl;
-      return quic::QUIC_FAILURE;
+      return nullptr;
+    }
+    X509_STORE_up_ref(store_.get());
+    return bssl::UniquePtr<X509_STORE>(store_.get());
+  }
+
+  std::string CertificateTrustStore::CacheKey(const std::string &hostname,
+                                              const std::vector<std::string> &certs)
+  {
+    SHA256_CTX sha;
+    SHA256_Init(&sha);
+    // Length-prefix every field so different splits can't collide.
+    auto add = [&sha](const std::string &field)
+    {
+      uint64_t size = field.size();
+      SHA256_Update(&sha, &size, sizeof(size));
+      SHA256_Update(&sha, field.data(), field.size());
+    };
+    add(hostname);
+    for (const auto &cert : certs)
+    {
+      add(cert);
     }
+    std::string key(SHA256_DIGEST_LENGTH, '\0');
+    SHA256_Final(reinterpret_cast<uint8_t *>(&key[0]), &sha);
+    return key;
+  }
 
+  bool CertificateTrustStore::IsVerified(const std::string &key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_index_.find(key);
+    if (it == results_index_.end())
+    {
+      return false;
+    }
+    if (it->second->not_after <= static_cast<int64_t>(std::time(nullptr)))
+    {
+      results_.erase(it->second);
+      results_index_.erase(it);
+      return false;
+    }
+    results_.splice(results_.begin(), results_, it->second);
+    return true;
+  }
+
+  void CertificateTrustStore::AddVerified(const std::string &key, int64_t not_after)
+  {
+    if (max_cached_results_ == 0 || not_after <= static_cast<int64_t>(std::time(nullptr)))
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_index_.find(key);
+    if (it != results_index_.end())
+    {
+      it->second->not_after = not_after;
+      results_.splice(results_.begin(), results_, it->second);
+      return;
+    }
+    results_.push_front(CachedResult{key, not_after});
+    results_index_[key] = results_.begin();
+    if (results_.size() > max_cached_results_)
+    {
+      results_index_.erase(results_.back().key);
+      results_.pop_back();
+    }
+  }
+
+  bool CertificateTrustStore::Verify(const std::string &hostname,
+                                     const std::vector<std::string> &certs,
+                                     const std::string &cache_key)
+  {
     std::vector<X509 *> x509_chain;
     for (const auto &cert_str : certs)
     {
@@ -105,106 +260,34 @@ namespace webtransport
         {
           X509_free(c);
         }
-        return quic::QUIC_FAILURE;
+        return false;
       }
       x509_chain.push_back(cert);
     }
 
     bool valid = false;
 
-    if (use_public_key_)
     {
-      // Pinned certificate verification.
-      if (x509_chain.size() == 1)
-      {
-        std::string pinned_cert_data;
-        if (!LoadFile(public_key_file_, pinned_cert_data))
-        {
-          std::cerr << "Failed to load pinned certificate from file: "
-                    << public_key_file_ << std::endl;
-        }
-        else
-        {
-          X509 *pinned_cert = LoadCertificate(pinned_cert_data);
-          if (!pinned_cert)
-          {
-            std::cerr << "Failed to parse pinned certificate." << std::endl;
-          }
-          else
-          {
-            if (X509_cmp(x509_chain[0], pinned_cert) == 0)
-            {
-              std::cerr << "Pinned certificate verification OK!" << std::endl;
-              valid = true;
-            }
-            else
-            {
-              std::cerr << "Pinned certificate verification failed." << std::endl;
-            }
-            X509_free(pinned_cert);
-          }
-        }
-      }
-      else
-      {
-        std::cerr << "Public key verification supports only self-signed certificates (chain size == 1)." << std::endl;
-      }
-    }
-    else
-    {
-      // CA chain verification.
-      X509_STORE *store = X509_STORE_new();
+      bssl::UniquePtr<X509_STORE> store = GetStore();
       if (!store)
       {
-        std::cerr << "Failed to create X509_STORE." << std::endl;
+        std::cerr << "No CA certificates available." << std::endl;
         for (auto c : x509_chain)
         {
           X509_free(c);
         }
-        return quic::QUIC_FAILURE;
-      }
-
-      // Use provided CA bundle/directory if available, else use default paths.
-      if (!ca_cert_bundle_path_.empty() || !ca_cert_dir_.empty())
-      {
-        if (X509_STORE_load_locations(
-                store,
-                ca_cert_bundle_path_.empty() ? nullptr : ca_cert_bundle_path_.c_str(),
-                ca_cert_dir_.empty() ? nullptr : ca_cert_dir_.c_str()) != 1)
-        {
-          std::cerr << "Failed to load CA certificates from specified locations." << std::endl;
-          X509_STORE_free(store);
-          for (auto c : x509_chain)
-          {
-            X509_free(c);
-          }
-          return quic::QUIC_FAILURE;
-        }
-      }
-      else
-      {
-        if (X509_STORE_set_default_paths(store) != 1)
-        {
-          std::cerr << "Failed to set default paths on X509_STORE." << std::endl;
-          X509_STORE_free(store);
-          for (auto c : x509_chain)
-          {
-            X509_free(c);
-          }
-          return quic::QUIC_FAILURE;
-        }
+        return false;
       }
 
       X509_STORE_CTX *ctx = X509_STORE_CTX_new();
       if (!ctx)
       {
         std::cerr << "Failed to create X509_STORE_CTX." << std::endl;
-        X509_STORE_free(store);
         for (auto c : x509_chain)
         {
           X509_free(c);
         }
-        return quic::QUIC_FAILURE;
+        return false;
       }
 
       STACK_OF(X509) *untrusted = nullptr;
@@ -218,18 +301,17 @@ namespace webtransport
         untrusted = intermediates;
       }
 
-      if (X509_STORE_CTX_init(ctx, store, x509_chain[0], untrusted) != 1)
+      if (X509_STORE_CTX_init(ctx, store.get(), x509_chain[0], untrusted) != 1)
       {
         std::cerr << "Failed to initialize X509_STORE_CTX." << std::endl;
         X509_STORE_CTX_free(ctx);
-        X509_STORE_free(store);
         if (untrusted)
           sk_X509_free(untrusted);
         for (auto c : x509_chain)
         {
           X509_free(c);
         }
-        return quic::QUIC_FAILURE;
+        return false;
       }
 
       if (X509_verify_cert(ctx) == 1)
@@ -238,6 +320,7 @@ namespace webtransport
         {
           std::cerr << "Hostname verification OK!" << std::endl;
           valid = true;
+          AddVerified(cache_key, ChainNotAfter(x509_chain));
         }
         else
         {
@@ -252,7 +335,6 @@ namespace webtransport
       }
 
       X509_STORE_CTX_free(ctx);
-      X509_STORE_free(store);
       if (untrusted)
         sk_X509_free(untrusted);
     }
@@ -263,7 +345,291 @@ namespace webtransport
       X509_free(cert);
     }
 
-    return valid ? quic::QUIC_SUCCESS : quic::QUIC_FAILURE;
+    return valid;
+  }
+
+  class VerificationPool::PollAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+  {
+  public:
+    explicit PollAlarmDelegate(VerificationPool *pool) : pool_(pool) {}
+
+    void OnAlarm() override { pool_->DeliverResults(); }
+
+  private:
+    VerificationPool *pool_;
+  };
+
+  VerificationPool::VerificationPool(quic::QuicAlarmFactory *alarm_factory,
+                                     const quic::QuicClock *clock, size_t num_threads)
+      : clock_(clock),
+        poll_alarm_(alarm_factory->CreateAlarm(new PollAlarmDelegate(this)))
+  {
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+      threads_.emplace_back([this]()
+                            { WorkerLoop(); });
+    }
+  }
+
+  VerificationPool::~VerificationPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto &thread : threads_)
+    {
+      thread.join();
+    }
+    poll_alarm_->Cancel();
+  }
+
+  void VerificationPool::Post(std::function<bool()> work, std::function<void(bool)> done)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(Task{std::move(work), std::move(done)});
+    }
+    work_available_.notify_one();
+
+    ++outstanding_;
+    if (!poll_alarm_->IsSet())
+    {
+      poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+    }
+  }
+
+  void VerificationPool::WorkerLoop()
+  {
+    while (true)
+    {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_available_.wait(lock, [this]()
+                             { return stopping_ || !tasks_.empty(); });
+        if (stopping_)
+        {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+
+      bool ok = task.work();
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      results_.push_back(Result{std::move(task.done), ok});
+    }
+  }
+
+  void VerificationPool::DeliverResults()
+  {
+    std::vector<Result> results;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      results.swap(results_);
+    }
+
+    outstanding_ -= results.size();
+    for (auto &result : results)
+    {
+      result.done(result.ok);
+    }
+
+    if (outstanding_ > 0)
+    {
+      poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+    }
+  }
+
+  bool CertificatePins::AddCertificateHash(const std::string &sha256_hex)
+  {
+    std::string hash;
+    if (!ParseSha256Hex(sha256_hex, &hash))
+    {
+      return false;
+    }
+    certificate_hashes_.insert(std::move(hash));
+    return true;
+  }
+
+  bool CertificatePins::AddPublicKeyHash(const std::string &sha256_hex)
+  {
+    std::string hash;
+    if (!ParseSha256Hex(sha256_hex, &hash))
+    {
+      return false;
+    }
+    public_key_hashes_.insert(std::move(hash));
+    return true;
+  }
+
+  bool CertificatePins::AddCertificateFile(const std::string &filename)
+  {
+    std::string contents;
+    if (!LoadFile(filename, contents))
+    {
+      return false;
+    }
+    bssl::UniquePtr<X509> cert(LoadCertificate(contents));
+    if (!cert)
+    {
+      return false;
+    }
+    uint8_t *der = nullptr;
+    int der_len = i2d_X509(cert.get(), &der);
+    if (der_len <= 0)
+    {
+      return false;
+    }
+    certificate_hashes_.insert(
+        Sha256(absl::string_view(reinterpret_cast<const char *>(der), der_len)));
+    OPENSSL_free(der);
+    return true;
+  }
+
+  bool CertificatePins::Matches(const std::string &leaf_der) const
+  {
+    if (certificate_hashes_.count(Sha256(leaf_der)) > 0)
+    {
+      return true;
+    }
+    if (public_key_hashes_.empty())
+    {
+      return false;
+    }
+
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(leaf_der.data());
+    bssl::UniquePtr<X509> cert(d2i_X509(nullptr, &p, leaf_der.size()));
+    if (!cert)
+    {
+      return false;
+    }
+    uint8_t *spki = nullptr;
+    int spki_len = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(cert.get()), &spki);
+    if (spki_len <= 0)
+    {
+      return false;
+    }
+    bool matched = public_key_hashes_.count(Sha256(
+                       absl::string_view(reinterpret_cast<const char *>(spki), spki_len))) > 0;
+    OPENSSL_free(spki);
+    return matched;
+  }
+
+  BoringSSLProofVerifier::BoringSSLProofVerifier()
+      : public_key_file_(""),
+        ca_cert_bundle_path_(""),
+        ca_cert_dir_(""),
+        use_public_key_(false),
+        trust_store_(std::make_shared<CertificateTrustStore>("", "")) {}
+
+  BoringSSLProofVerifier::BoringSSLProofVerifier(
+      const std::string &public_key_file,
+      const std::string &ca_cert_bundle_path,
+      const std::string &ca_cert_dir)
+      : public_key_file_(public_key_file),
+        ca_cert_bundle_path_(ca_cert_bundle_path),
+        ca_cert_dir_(ca_cert_dir),
+        use_public_key_(!public_key_file.empty())
+  {
+    if (use_public_key_)
+    {
+      // Hash the pinned certificate once instead of re-reading it per handshake.
+      auto pins = std::make_shared<CertificatePins>();
+      if (!pins->AddCertificateFile(public_key_file))
+      {
+        std::cerr << "Failed to load pinned certificate from file: "
+                  << public_key_file << std::endl;
+      }
+      pins_ = std::move(pins);
+    }
+    else
+    {
+      trust_store_ = std::make_shared<CertificateTrustStore>(ca_cert_bundle_path, ca_cert_dir);
+    }
+  }
+
+  BoringSSLProofVerifier::BoringSSLProofVerifier(
+      std::shared_ptr<CertificateTrustStore> trust_store)
+      : use_public_key_(false),
+        trust_store_(std::move(trust_store)) {}
+
+  BoringSSLProofVerifier::BoringSSLProofVerifier(
+      std::shared_ptr<const CertificatePins> pins)
+      : use_public_key_(true),
+        pins_(std::move(pins)) {}
+
+  // This method is a stub that simply prints a message and returns success.
+  quic::QuicAsyncStatus BoringSSLProofVerifier::VerifyProof(
+      const std::string &hostname, const uint16_t port,
+      const std::string &server_config, quic::QuicTransportVersion transport_version,
+      absl::string_view chlo_hash, const std::vector<std::string> &certs,
+      const std::string &cert_sct, const std::string &signature,
+      const quic::ProofVerifyContext *context, std::string *error_details,
+      std::unique_ptr<quic::ProofVerifyDetails> *details,
+      std::unique_ptr<quic::ProofVerifierCallback> callback)
+  {
+    std::cerr << "[+] Checking VerifyProof instead" << std::endl;
+    return quic::QUIC_SUCCESS;
+  }
+
+  quic::QuicAsyncStatus BoringSSLProofVerifier::VerifyCertChain(
+      const std::string &hostname, const uint16_t port,
+      const std::vector<std::string> &certs, const std::string &ocsp_response,
+      const std::string &cert_sct, const quic::ProofVerifyContext *context,
+      std::string *error_details, std::unique_ptr<quic::ProofVerifyDetails> *details,
+      uint8_t *out_alert, std::unique_ptr<quic::ProofVerifierCallback> callback)
+  {
+    if (certs.empty())
+    {
+      std::cerr << "No certificates provided." << std::endl;
+      return quic::QUIC_FAILURE;
+    }
+
+    if (use_public_key_)
+    {
+      // Pinned verification: one hash of the leaf and a set lookup.
+      if (pins_ && pins_->Matches(certs[0]))
+      {
+        return quic::QUIC_SUCCESS;
+      }
+      std::cerr << "Pinned certificate verification failed." << std::endl;
+      if (error_details)
+      {
+        *error_details = "Certificate does not match any pinned hash";
+      }
+      return quic::QUIC_FAILURE;
+    }
+
+    // A chain that verified for this hostname before needs no parsing at all.
+    std::string cache_key = CertificateTrustStore::CacheKey(hostname, certs);
+    if (trust_store_->IsVerified(cache_key))
+    {
+      return quic::QUIC_SUCCESS;
+    }
+
+    if (pool_)
+    {
+      // Build the chain on a worker so a slow verification doesn't stall
+      // other connections on the loop. The callback is owned by the task.
+      std::shared_ptr<quic::ProofVerifierCallback> shared_callback(std::move(callback));
+      pool_->Post(
+          [trust_store = trust_store_, hostname, certs, cache_key]()
+          { return trust_store->Verify(hostname, certs, cache_key); },
+          [shared_callback](bool ok)
+          {
+            std::unique_ptr<quic::ProofVerifyDetails> verify_details;
+            shared_callback->Run(ok, ok ? "" : "Certificate verification failed",
+                                 &verify_details);
+          });
+      return quic::QUIC_PENDING;
+    }
+
+    return trust_store_->Verify(hostname, certs, cache_key) ? quic::QUIC_SUCCESS
+                                                             : quic::QUIC_FAILURE;
   }
 
   std::unique_ptr<quic::ProofVerifyContext> BoringSSLProofVerifier::CreateDefaultContext()
@@ -2,21 +2,163 @@
 #define WEB_TRANSPORT_CLIENT_VERIFY_H
 
 #include <openssl/x509.h>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
 #include <string>
-#include <vector>
-#include <memory>
-#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include "quiche/quic/core/crypto/proof_verifier.h"
+#include "quiche/quic/core/quic_alarm.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/core/quic_clock.h"
 
 // The WebTransport namespace.
 namespace webtransport
 {
 
+    // CertificateTrustStore owns the X509_STORE built from a CA bundle and/or
+    // directory (or the system default paths) and an LRU cache of recent
+    // successful chain verifications. It is shared by every verifier of a
+    // Client, so the CA files are read once rather than on every handshake.
+    class CertificateTrustStore
+    {
+    public:
+        CertificateTrustStore(const std::string &ca_cert_bundle_path,
+                              const std::string &ca_cert_dir,
+                              size_t max_cached_results = 256);
+
+        // Rebuilds the store from disk, e.g. after the CA files changed, and
+        // forgets every cached verification. Returns false and keeps the
+        // previous store if loading fails.
+        bool Reload();
+
+        // Returns the current store with an extra reference, or null if none
+        // could be loaded. Verifications in flight keep using the store they
+        // started with across a Reload().
+        bssl::UniquePtr<X509_STORE> GetStore();
+
+        // Key for the verification cache: a SHA-256 over the hostname and the
+        // whole DER chain.
+        static std::string CacheKey(const std::string &hostname,
+                                    const std::vector<std::string> &certs);
+
+        // Returns true if `key` verified successfully before and none of the
+        // certificates in that chain have expired since.
+        bool IsVerified(const std::string &key);
+
+        // Remembers a successful verification until `not_after`, the earliest
+        // notAfter in the chain.
+        void AddVerified(const std::string &key, int64_t not_after);
+
+        // Builds and checks the DER chain `certs` for `hostname`, caching a
+        // success under `cache_key`. Safe to call from any thread.
+        bool Verify(const std::string &hostname, const std::vector<std::string> &certs,
+                    const std::string &cache_key);
+
+    private:
+        struct CachedResult
+        {
+            std::string key;
+            int64_t not_after;
+        };
+
+        std::string ca_cert_bundle_path_;
+        std::string ca_cert_dir_;
+        size_t max_cached_results_;
+        std::mutex mutex_;
+        bssl::UniquePtr<X509_STORE> store_;
+        // Most recently used first.
+        std::list<CachedResult> results_;
+        std::unordered_map<std::string, std::list<CachedResult>::iterator> results_index_;
+    };
+
+    // CertificatePins is a set of SHA-256 hashes the server's leaf certificate
+    // must match, the model of WebTransport's serverCertificateHashes. Hashes
+    // are either over the whole DER certificate or over its
+    // SubjectPublicKeyInfo; the latter survives certificate renewal with the
+    // same key. The chain may be of any length; only the leaf is checked.
+    class CertificatePins
+    {
+    public:
+        // `sha256_hex` is 64 hex digits, optionally colon separated. Returns
+        // false if it isn't a valid SHA-256 hash.
+        bool AddCertificateHash(const std::string &sha256_hex);
+        bool AddPublicKeyHash(const std::string &sha256_hex);
+
+        // Pins the certificate in a PEM or DER file by its hash.
+        bool AddCertificateFile(const std::string &filename);
+
+        bool empty() const
+        {
+            return certificate_hashes_.empty() && public_key_hashes_.empty();
+        }
+
+        // Returns true if the DER leaf certificate matches any pin. Only SPKI
+        // pins require parsing the certificate.
+        bool Matches(const std::string &leaf_der) const;
+
+    private:
+        std::set<std::string> certificate_hashes_;
+        std::set<std::string> public_key_hashes_;
+    };
+
+    // VerificationPool runs certificate verifications on worker threads and
+    // hands each result back on the event loop thread, where it is polled
+    // for like other client-side completions.
+    class VerificationPool
+    {
+    public:
+        VerificationPool(quic::QuicAlarmFactory *alarm_factory, const quic::QuicClock *clock,
+                         size_t num_threads = 2);
+        ~VerificationPool();
+
+        VerificationPool(const VerificationPool &) = delete;
+        VerificationPool &operator=(const VerificationPool &) = delete;
+
+        // Runs `work` on a worker, then `done` with its result on the loop.
+        void Post(std::function<bool()> work, std::function<void(bool)> done);
+
+    private:
+        class PollAlarmDelegate;
+
+        struct Task
+        {
+            std::function<bool()> work;
+            std::function<void(bool)> done;
+        };
+
+        struct Result
+        {
+            std::function<void(bool)> done;
+            bool ok;
+        };
+
+        void WorkerLoop();
+        void DeliverResults();
+
+        const quic::QuicClock *clock_;
+        std::unique_ptr<quic::QuicAlarm> poll_alarm_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::deque<Task> tasks_;
+        std::vector<Result> results_;
+        bool stopping_ = false;
+        // Posted tasks whose result hasn't been delivered; loop thread only.
+        size_t outstanding_ = 0;
+    };
+
     // BoringSSLProofVerifier implements a QUIC ProofVerifier interface.
     // It supports two modes:
-    //  1. Pinned certificate mode (if public_key_file is provided).
+    //  1. Pinned mode (if public_key_file or a set of pins is provided).
     //  2. CA chain verification mode (using a CA bundle or directory, or default store).
     class BoringSSLProofVerifier : public quic::ProofVerifier
     {
@@ -31,6 +173,17 @@ namespace webtransport
                                const std::string &ca_cert_bundle_path,
                                const std::string &ca_cert_dir);
 
+        // Verifies chains against a trust store shared with other verifiers.
+        explicit BoringSSLProofVerifier(std::shared_ptr<CertificateTrustStore> trust_store);
+
+        // Accepts only leaf certificates matching `pins`, without any CA checks.
+        explicit BoringSSLProofVerifier(std::shared_ptr<const CertificatePins> pins);
+
+        // Moves chain verification that misses the cache onto `pool`, making
+        // VerifyCertChain() return QUIC_PENDING. `pool` must outlive the
+        // handshakes using this verifier. Pinned verification stays inline.
+        void set_verification_pool(VerificationPool *pool) { pool_ = pool; }
+
         // Override of ProofVerifier::VerifyProof.
         quic::QuicAsyncStatus VerifyProof(
             const std::string &hostname, const uint16_t port,
@@ -57,6 +210,9 @@ namespace webtransport
         std::string ca_cert_bundle_path_;
         std::string ca_cert_dir_;
         bool use_public_key_;
+        std::shared_ptr<CertificateTrustStore> trust_store_;
+        std::shared_ptr<const CertificatePins> pins_;
+        VerificationPool *pool_ = nullptr;
     };
 
     // Helper function declarations.
@@ -8,35 +8,99 @@
 #endif
 
 #include <deque>
+#include <sstream>
+#include <openssl/rand.h>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/web_transport_interface.h"
 #include "quiche/quic/platform/api/quic_logging.h"
 #include "quiche/common/platform/api/quiche_logging.h"
+#include "quiche/common/platform/api/quiche_mem_slice.h"
 #include "quiche/common/quiche_circular_deque.h"
 #include "quiche/common/quiche_stream.h"
 #include "quiche/common/simple_buffer_allocator.h"
+#include "quiche/quic/core/quic_default_clock.h"
 #include "quiche/web_transport/complete_buffer_visitor.h"
 #include "quiche/web_transport/web_transport.h"
 
 namespace webtransport
 {
 
+    namespace
+    {
+
+        // Keys address tokens when no secret is configured. Generated once, so
+        // every server in the process accepts the others' tokens.
+        const std::string &ProcessTokenSecret()
+        {
+            static const std::string secret = []()
+            {
+                std::string bytes(32, '\0');
+                RAND_bytes(reinterpret_cast<uint8_t *>(bytes.data()), bytes.size());
+                return bytes;
+            }();
+            return secret;
+        }
+
+    } // namespace
+
     // StreamWrapper implementation
     class Server::StreamWrapper : public quic::WebTransportStreamVisitor,
                                   public ServerUnidirectionalStream,
                                   public ServerBidirectionalStream
     {
     public:
-        StreamWrapper(quic::WebTransportStream *stream, Server *server)
-            : stream_(stream), server_(server) {}
+        StreamWrapper(quic::WebTransportStream *stream, Server *server, bool bidirectional)
+            : stream_(stream), server_(server), bidirectional_(bidirectional) {}
 
-        ~StreamWrapper() override {}
+        ~StreamWrapper() override
+        {
+            if (close_cb_)
+            {
+                close_cb_();
+            }
+        }
 
         void Send(const std::vector<uint8_t>& data) override {
             stream_->Write(absl::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
         }
 
+        bool Send(std::shared_ptr<const std::vector<uint8_t>> data) override
+        {
+            if (!data || data->empty())
+            {
+                return true;
+            }
+            const char *bytes = reinterpret_cast<const char *>(data->data());
+            size_t size = data->size();
+            quiche::QuicheMemSlice slice(quiche::QuicheMemSlice::InPlace(), std::move(data), bytes, size);
+            return stream_->Writev(absl::MakeSpan(&slice, 1), quiche::StreamWriteOptions()).ok();
+        }
+
+        bool Send(std::shared_ptr<const std::vector<uint8_t>> header,
+                  std::shared_ptr<const std::vector<uint8_t>> payload) override
+        {
+            quiche::QuicheMemSlice slices[2];
+            size_t count = 0;
+            for (auto *part : {&header, &payload})
+            {
+                if (!*part || (*part)->empty())
+                {
+                    continue;
+                }
+                const char *bytes = reinterpret_cast<const char *>((*part)->data());
+                size_t size = (*part)->size();
+                slices[count++] = quiche::QuicheMemSlice(quiche::QuicheMemSlice::InPlace(), std::move(*part), bytes, size);
+            }
+            if (count == 0)
+            {
+                return true;
+            }
+            // quiche takes all slices of a Writev or none.
+            return stream_->Writev(absl::MakeSpan(slices, count), quiche::StreamWriteOptions()).ok();
+        }
+
         void setInterval(uint64_t interval_ms, std::function<void()> cb) override
         {
             auto *clock = server_->server_->event_loop()->GetClock();
@@ -47,39 +111,126 @@ namespace webtransport
             interval_alarm_->Set(clock->Now() + quic::QuicTime::Delta::FromMilliseconds(interval_ms));
         }
 
+        bool CanWrite() const override
+        {
+            return bidirectional_ && stream_->CanWrite();
+        }
+
+        bool Close() override
+        {
+            return bidirectional_ && stream_->SendFin();
+        }
+
+        void Reset(uint64_t error_code) override
+        {
+            auto code = static_cast<quic::WebTransportStreamError>(error_code);
+            if (bidirectional_)
+            {
+                stream_->ResetWithUserCode(code);
+            }
+            stream_->SendStopSending(code);
+        }
+
         // WebTransportStreamVisitor overrides
         void OnCanRead() override
         {
-            if (data_cb_)
+            if (!data_cb_ && !fin_cb_)
+            {
+                return;
+            }
+
+            std::string buffer;
+            auto result = stream_->Read(&buffer);
+            if (result.bytes_read > 0 && data_cb_)
             {
-                std::string buffer;
-                auto result = stream_->Read(&buffer);
                 std::vector<uint8_t> data(buffer.begin(), buffer.end());
                 data_cb_(data);
             }
+            if (result.fin)
+            {
+                FinCallback fin_cb = std::move(fin_cb_);
+                ReleaseReadCallbacks();
+                if (fin_cb)
+                {
+                    fin_cb();
+                }
+            }
         }
 
         void OnCanWrite() override {}
-        void OnResetStreamReceived(quic::WebTransportStreamError) override {}
-        void OnStopSendingReceived(quic::WebTransportStreamError) override {}
+
+        void OnResetStreamReceived(quic::WebTransportStreamError error) override
+        {
+            ResetCallback reset_cb = std::move(reset_cb_);
+            ReleaseReadCallbacks();
+            if (reset_cb)
+            {
+                reset_cb(error);
+            }
+        }
+
+        void OnStopSendingReceived(quic::WebTransportStreamError error) override
+        {
+            if (stop_sending_cb_)
+            {
+                stop_sending_cb_(error);
+            }
+        }
+
         void OnWriteSideInDataRecvdState() override {}
 
     private:
+        // Nothing more will be read, so let go of whatever the read callbacks
+        // captured now rather than when quiche destroys the stream.
+        void ReleaseReadCallbacks()
+        {
+            data_cb_ = nullptr;
+            fin_cb_ = nullptr;
+            reset_cb_ = nullptr;
+        }
+
         quic::WebTransportStream* stream_;
         Server* server_;
+        bool bidirectional_;
         std::unique_ptr<quic::QuicAlarm> interval_alarm_;
-        std::function<void()> fin_cb_;
-        std::function<void(uint64_t error_code)> reset_cb_;
     };
 
     // SessionWrapper implementation
     class Server::SessionWrapper : public quic::WebTransportVisitor, public ServerSession
     {
     public:
-        SessionWrapper(quic::WebTransportSession *session, Server *server, const std::string &path = "")
-            : session_(session), server_(server), path_(path), session_closed_(false) {}
+        SessionWrapper(quic::WebTransportSession *session, Server *server, const std::string &path,
+                       SessionRequest request)
+            : session_(session), server_(server), path_(path), request_(std::move(request)),
+              session_closed_(false), id_(server->sessions_.Add(this, path)) {}
 
-        ~SessionWrapper() override {}
+        ~SessionWrapper() override
+        {
+            NotifyClosed();
+            server_->sessions_.Remove(id_);
+            server_->pending_sessions_.erase(id_);
+            server_->admission_.OnSessionClosed(path_);
+        }
+
+        // Applies the outcome of a deferred session callback by sending the
+        // held CONNECT response.
+        void Decide(const SessionDecisionQueue::Decision &decision)
+        {
+            pending_ = false;
+            if (!decision.accept)
+            {
+                // The client never saw the session, so it gets the status
+                // rather than a close.
+                session_closed_ = true;
+                datagram_cb_ = nullptr;
+                server_->backend_->SendHeldResponse(session_, std::to_string(decision.status));
+                return;
+            }
+            server_->backend_->SendHeldResponse(session_, "200");
+            // Deliver the streams that arrived while the decision was pending.
+            OnIncomingUnidirectionalStreamAvailable();
+            OnIncomingBidirectionalStreamAvailable();
+        }
 
         // ServerSession implementation
         void SendDatagram(const std::vector<uint8_t> &data) override
@@ -104,6 +255,14 @@ namespace webtransport
         // RejectSession implementation
         void RejectSession(uint32_t error_code, const std::string &reason) override
         {
+            // Still undecided: the client hasn't seen the session yet.
+            if (pending_)
+            {
+                server_->pending_sessions_.erase(id_);
+                Decide({id_, false, 403});
+                return;
+            }
+
             reject_error_code_ = error_code;
             reject_reason_ = reason;
             should_reject_ = true;
@@ -121,6 +280,9 @@ namespace webtransport
             // If OnSessionReady hasn't been called yet, it will handle rejection when it's called
         }
 
+        const SessionRequest &request() const override { return request_; }
+        SessionId id() const override { return id_; }
+
         // WebTransportVisitor implementation
         void OnSessionReady() override
         {
@@ -138,6 +300,17 @@ namespace webtransport
                 return;
             }
 
+            // Hold the session until the deferred callback's decision arrives.
+            if (server_->deferred_session_cb_)
+            {
+                pending_ = true;
+                server_->pending_sessions_[id_] = this;
+                server_->ScheduleSessionDecisions();
+                server_->deferred_session_cb_(
+                    std::make_shared<PendingSession>(server_->session_decisions_, id_, this, path_));
+                return;
+            }
+
             // Otherwise, call the session callback to determine if we should accept
             bool accept = true;
             if (server_->session_cb_)
@@ -155,7 +328,7 @@ namespace webtransport
 
         void OnDatagramReceived(absl::string_view datagram) override
         {
-            if (datagram_cb_ && !session_closed_)
+            if (datagram_cb_ && !session_closed_ && !pending_)
             {
                 std::vector<uint8_t> data(datagram.begin(), datagram.end());
                 datagram_cb_(data);
@@ -164,12 +337,13 @@ namespace webtransport
 
         void OnIncomingUnidirectionalStreamAvailable() override
         {
-            if (session_closed_)
+            // Streams wait in quiche, under flow control, while pending.
+            if (session_closed_ || pending_)
                 return;
 
             while (auto *stream = session_->AcceptIncomingUnidirectionalStream())
             {
-                auto wrapper = std::make_unique<StreamWrapper>(stream, server_);
+                auto wrapper = std::make_unique<StreamWrapper>(stream, server_, /*bidirectional=*/false);
                 ServerUnidirectionalStream *stream_ptr = wrapper.get();
                 stream->SetVisitor(std::move(wrapper));
 
@@ -182,12 +356,12 @@ namespace webtransport
 
         void OnIncomingBidirectionalStreamAvailable() override
         {
-            if (session_closed_)
+            if (session_closed_ || pending_)
                 return;
 
             while (auto *stream = session_->AcceptIncomingBidirectionalStream())
             {
-                auto wrapper = std::make_unique<StreamWrapper>(stream, server_);
+                auto wrapper = std::make_unique<StreamWrapper>(stream, server_, /*bidirectional=*/true);
                 ServerBidirectionalStream *stream_ptr = wrapper.get();
                 stream->SetVisitor(std::move(wrapper));
 
@@ -201,6 +375,13 @@ namespace webtransport
         void OnSessionClosed(quic::WebTransportSessionError error, const std::string &reason) override
         {
             session_closed_ = true;
+            datagram_cb_ = nullptr;
+            if (session_closed_cb_)
+            {
+                SessionClosedCallback cb = std::move(session_closed_cb_);
+                cb(error, reason);
+            }
+            NotifyClosed();
         }
 
         void OnCanCreateNewOutgoingBidirectionalStream() override {}
@@ -210,6 +391,7 @@ namespace webtransport
         quic::WebTransportSession *session_;
         Server *server_;
         std::string path_;
+        SessionRequest request_;
         std::unique_ptr<quic::QuicAlarm> interval_alarm_;
 
         // Session state tracking
@@ -218,36 +400,210 @@ namespace webtransport
         bool should_reject_ = false;
         uint32_t reject_error_code_ = 0;
         std::string reject_reason_;
+
+        SessionId id_;
+        // Deferred acceptance
+        bool pending_ = false;
+    };
+
+    class Server::DecisionAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+    {
+    public:
+        explicit DecisionAlarmDelegate(Server *server) : server_(server) {}
+
+        void OnAlarm() override { server_->ApplySessionDecisions(); }
+
+    private:
+        Server *server_;
     };
 
     // Server implementation
     Server::Server(const std::string &host, uint16_t port)
         : host_(host), port_(port), server_initialized_(false) {}
 
-    std::unique_ptr<quic::ProofSource> Server::CreateProofSource()
+    Server::~Server()
+    {
+        // These alarms belong to server_'s event loop.
+        admission_.StopLagMonitor();
+        broadcaster_.Stop();
+        if (decision_alarm_)
+        {
+            decision_alarm_->Cancel();
+        }
+        decision_alarm_.reset();
+        alarm_factory_.reset();
+    }
+
+    void Server::ScheduleSessionDecisions()
+    {
+        if (!decision_alarm_->IsSet())
+        {
+            auto *clock = server_->event_loop()->GetClock();
+            decision_alarm_->Set(clock->Now() + quic::QuicTime::Delta::FromMilliseconds(1));
+        }
+    }
+
+    void Server::ApplySessionDecisions()
+    {
+        for (const auto &decision : session_decisions_->TakeAll())
+        {
+            // Sessions closed in the meantime are gone from the map.
+            auto it = pending_sessions_.find(decision.session_id);
+            if (it == pending_sessions_.end())
+            {
+                continue;
+            }
+            SessionWrapper *session = it->second;
+            pending_sessions_.erase(it);
+            session->Decide(decision);
+        }
+
+        if (!pending_sessions_.empty())
+        {
+            ScheduleSessionDecisions();
+        }
+    }
+
+    void Server::addCertificateFiles(const std::string &cert_file, const std::string &key_file)
+    {
+        std::lock_guard<std::mutex> lock(certificates_mutex_);
+        certificate_files_.emplace_back(cert_file, key_file);
+    }
+
+    void Server::addCertificate(const std::string &chain_pem, const std::string &key_pem)
+    {
+        std::lock_guard<std::mutex> lock(certificates_mutex_);
+        certificates_.push_back(CertificatePem{chain_pem, key_pem});
+    }
+
+    bool Server::reloadCertificates()
+    {
+        std::vector<CertificatePem> certificates;
+        {
+            std::lock_guard<std::mutex> lock(certificates_mutex_);
+            certificates = certificates_;
+        }
+        return updateCertificates(std::move(certificates));
+    }
+
+    bool Server::updateCertificates(std::vector<CertificatePem> certificates)
+    {
+        std::lock_guard<std::mutex> lock(certificates_mutex_);
+        std::vector<CertificatePem> previous = std::move(certificates_);
+        certificates_ = std::move(certificates);
+
+        std::string error;
+        auto loaded = LoadCertificates(&error);
+        if (!loaded)
+        {
+            QUICHE_LOG(ERROR) << "Keeping current certificates: " << error;
+            certificates_ = std::move(previous);
+            return false;
+        }
+        if (certificate_source_)
+        {
+            certificate_source_->Update(std::move(loaded));
+        }
+        return true;
+    }
+
+    std::shared_ptr<const CertificateSet> Server::LoadCertificates(std::string *error)
     {
-        std::ifstream cert_stream(cert_file_, std::ios::binary);
-        std::vector<std::string> certs = quic::CertificateView::LoadPemFromStream(&cert_stream);
-        if (certs.empty())
+        auto read_file = [](const std::string &path, std::string *contents)
         {
-            QUICHE_LOG(ERROR) << "Failed to load certificates from " << cert_file_;
-            exit(1);
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream)
+            {
+                return false;
+            }
+            std::stringstream buffer;
+            buffer << stream.rdbuf();
+            *contents = buffer.str();
+            return true;
+        };
+
+        std::vector<std::pair<std::string, std::string>> files;
+        if (!cert_file_.empty() || !key_file_.empty())
+        {
+            files.emplace_back(cert_file_, key_file_);
+        }
+        files.insert(files.end(), certificate_files_.begin(), certificate_files_.end());
+
+        std::vector<CertificatePem> pems;
+        for (const auto &[cert_file, key_file] : files)
+        {
+            CertificatePem pem;
+            if (!read_file(cert_file, &pem.chain))
+            {
+                *error = "Failed to read certificates from " + cert_file;
+                return nullptr;
+            }
+            if (!read_file(key_file, &pem.key))
+            {
+                *error = "Failed to read private key from " + key_file;
+                return nullptr;
+            }
+            pems.push_back(std::move(pem));
+        }
+        pems.insert(pems.end(), certificates_.begin(), certificates_.end());
+
+        return CertificateSet::Create(pems, error);
+    }
+
+    std::unique_ptr<ServerProofSource> Server::CreateProofSource()
+    {
+        std::shared_ptr<const CertificateSet> certificates;
+        {
+            std::lock_guard<std::mutex> lock(certificates_mutex_);
+            std::string error;
+            certificates = LoadCertificates(&error);
+            if (!certificates)
+            {
+                QUICHE_LOG(ERROR) << error;
+                return nullptr;
+            }
+        }
+
+        auto ticket_crypter = CreateTicketCrypter();
+        if (!ticket_crypter)
+        {
+            return nullptr;
         }
 
-        std::ifstream key_stream(key_file_, std::ios::binary);
-        auto private_key = quic::CertificatePrivateKey::LoadPemFromStream(&key_stream);
-        if (!private_key)
+        auto certificate_source = std::make_unique<CertificateProofSource>(std::move(certificates));
+        certificate_source_ = certificate_source.get();
+        auto proof_source = std::make_unique<ServerProofSource>(std::move(certificate_source));
+        proof_source->SetTicketCrypter(std::move(ticket_crypter));
+        return proof_source;
+    }
+
+    std::unique_ptr<quic::ProofSource::TicketCrypter> Server::CreateTicketCrypter()
+    {
+        auto rotation_interval = quic::QuicTime::Delta::FromSeconds(ticket_key_rotation_secs_);
+        std::shared_ptr<TicketKeyProvider> provider = ticket_key_provider_;
+        if (!provider && !ticket_key_file_.empty())
         {
-            QUICHE_LOG(ERROR) << "Failed to load private key from " << key_file_;
-            exit(1);
+            provider = TicketKeyProvider::ForFile(ticket_key_file_, rotation_interval);
+        }
+        else if (!provider && ticket_key_cb_)
+        {
+            provider = std::make_shared<TicketKeyProvider>(
+                ticket_key_cb_, rotation_interval, quic::QuicDefaultClock::Get());
+        }
+        else if (!provider)
+        {
+            provider = TicketKeyProvider::Random(rotation_interval);
         }
 
-        auto chain = quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain>(
-            new quic::ProofSource::Chain(certs));
-        return quic::ProofSourceX509::Create(chain, std::move(*private_key));
+        if (!provider->GetKeys())
+        {
+            QUICHE_LOG(ERROR) << "Failed to load session ticket keys";
+            return nullptr;
+        }
+        return std::make_unique<SharedTicketCrypter>(std::move(provider));
     }
 
-    void Server::InitializeServer()
+    bool Server::InitializeServer()
     {
 #ifdef _WIN32
         // Initialize Windows Sockets API
@@ -262,18 +618,53 @@ namespace webtransport
         // Create an event loop
         quiche::QuicheSystemEventLoop event_loop("webtransport_server");
 
+        admission_.set_config(admission_config_);
+
         // Create a backend that wraps each new session
         backend_ = std::make_unique<quic::WebTransportOnlyBackend>(
-            [this](absl::string_view path, quic::WebTransportSession *session, quic::QuicServer *server)
+            [this](absl::string_view path, quic::WebTransportSession *session, quic::QuicServer *server,
+                   const quiche::HttpHeaderBlock &request_headers,
+                   quiche::HttpHeaderBlock *response_headers)
+                -> absl::StatusOr<std::unique_ptr<webtransport::SessionVisitor>>
             {
+                // Refused requests are answered with 429 by the backend.
+                absl::Status admitted = admission_.Admit(path);
+                if (!admitted.ok())
+                {
+                    return admitted;
+                }
+
+                SessionRequest request(request_headers.Clone(), response_headers);
+                if (session_request_cb_ && !session_request_cb_(request))
+                {
+                    admission_.OnSessionClosed(path);
+                    return absl::PermissionDeniedError("Session refused by application");
+                }
+                request.CloseResponse();
+
                 // Store the path in the session wrapper instead of retrieving it later
                 std::string path_str(path.begin(), path.end());
-                auto wrapper = std::make_unique<SessionWrapper>(session, this, path_str);
+                auto wrapper = std::make_unique<SessionWrapper>(session, this, path_str, std::move(request));
                 return wrapper;
             });
+        // Deferred sessions are answered once the application decides.
+        backend_->SetHoldResponses(static_cast<bool>(deferred_session_cb_));
 
         auto proof_source = CreateProofSource();
-        server_ = std::make_unique<quic::QuicServer>(std::move(proof_source), backend_.get());
+        if (!proof_source)
+        {
+            return false;
+        }
+        proof_source_ = proof_source.get();
+        const std::string &token_secret = source_address_token_secret_.empty()
+                                              ? ProcessTokenSecret()
+                                              : source_address_token_secret_;
+        server_ = std::make_unique<GuardedQuicServer>(std::move(proof_source), backend_.get(),
+                                                      token_secret, chlo_config_);
+        if (max_sessions_per_socket_event_ > 0)
+        {
+            server_->set_max_sessions_to_create_per_socket_event(max_sessions_per_socket_event_);
+        }
         backend_->SetServer(server_.get());
 
         quic::QuicIpAddress ip;
@@ -283,10 +674,18 @@ namespace webtransport
         if (!server_->CreateUDPSocketAndListen(addr))
         {
             QUICHE_LOG(ERROR) << "Failed to bind to " << addr.ToString();
-            exit(1);
+            return false;
         }
 
+        // The event loop exists only once the server listens.
+        proof_source_->StartSigningPool(server_->event_loop(), signing_threads_);
+        admission_.StartLagMonitor(server_->event_loop());
+        alarm_factory_ = server_->event_loop()->CreateAlarmFactory();
+        decision_alarm_.reset(alarm_factory_->CreateAlarm(new DecisionAlarmDelegate(this)));
+        broadcaster_.Start(server_->event_loop());
+
         server_initialized_ = true;
+        return true;
     }
 
     void Server::Listen()
@@ -2,15 +2,27 @@
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <fstream>
 #include "quiche/common/platform/api/quiche_system_event_loop.h"
+#include "quiche_platform_impl/quiche_slab_buffer_allocator.h"
+#include "web_transport_server_admission.h"
 #include "web_transport_server_backend.h"
+#include "web_transport_server_certs.h"
+#include "web_transport_server_channel.h"
+#include "web_transport_server_chlo.h"
 #include "web_transport_server_core.h"
 #include "web_transport_server_interval.h"
+#include "web_transport_server_proof.h"
+#include "web_transport_server_registry.h"
 #include "web_transport_server_session.h"
 #include "web_transport_server_stream.h"
+#include "web_transport_server_ticket.h"
+#include "web_transport_server_topics.h"
 #include "quiche/quic/core/crypto/proof_source.h"
 #include "quiche/quic/core/crypto/proof_source_x509.h"
 
@@ -33,21 +45,124 @@ namespace webtransport
         using SessionCallback = std::function<bool(ServerSession *, std::string)>;
         using UnidirectionalStreamCallback = std::function<void(ServerSession *, ServerUnidirectionalStream *, std::string)>;
         using BidirectionalStreamCallback = std::function<void(ServerSession *, ServerBidirectionalStream *, std::string)>;
+        // Runs while the CONNECT request is answered; returning false refuses
+        // it with 403.
+        using SessionRequestCallback = std::function<bool(SessionRequest &)>;
+        // Receives sessions to be accepted or rejected later, from any thread.
+        using DeferredSessionCallback = std::function<void(std::shared_ptr<PendingSession>)>;
 
         Server(const std::string &host, uint16_t port);
-        ~Server() = default;
+        ~Server();
 
-        // Certificate configuration
+        // Certificate configuration. setCertFile/setKeyFile give the default
+        // certificate; further pairs are selected by SNI against their
+        // subjectAltNames, preferring ECDSA P-256 where a name has several.
         void setCertFile(const std::string &cert_file) { cert_file_ = cert_file; }
         void setKeyFile(const std::string &key_file) { key_file_ = key_file; }
+        void addCertificateFiles(const std::string &cert_file, const std::string &key_file);
+        void addCertificate(const std::string &chain_pem, const std::string &key_pem);
+
+        // Replace the certificates of a running server without dropping any
+        // connection. reloadCertificates() re-reads the certificate files;
+        // updateCertificates() also replaces those added from memory. Both may
+        // be called from any thread and keep the current certificates if any
+        // of the new ones fails to load.
+        bool reloadCertificates();
+        bool updateCertificates(std::vector<CertificatePem> certificates);
+
+        // Number of threads computing handshake signatures off the event loop;
+        // 0 signs inline.
+        void setSigningThreads(size_t num_threads) { signing_threads_ = num_threads; }
+
+        // Stream and datagram buffers come from a size-class pool shared by
+        // every server in the process; these apply to all of them.
+        void setHugePageBuffers(bool enabled) { quiche::SlabBufferAllocator::SetUseHugePages(enabled); }
+        static quiche::SlabBufferAllocatorStats bufferStats() { return quiche::SlabBufferAllocator::GetStats(); }
+
+        // Session ticket configuration. Without a key file, callback or provider
+        // tickets are sealed with per-process random keys, rotated like any
+        // other keys, so resumption only works until the server restarts.
+        void setTicketKeyFile(const std::string &key_file) { ticket_key_file_ = key_file; }
+        void setTicketKeyCallback(TicketKeyProvider::KeySource cb) { ticket_key_cb_ = std::move(cb); }
+        void setTicketKeyRotationInterval(uint64_t seconds) { ticket_key_rotation_secs_ = seconds; }
+        void setTicketKeyProvider(std::shared_ptr<TicketKeyProvider> provider) { ticket_key_provider_ = std::move(provider); }
+
+        // Keys the address tokens that let returning clients past the
+        // handshake rate limit. Defaults to a random per-process secret;
+        // servers behind one load balancer must all be given the same one.
+        void setSourceAddressTokenSecret(const std::string &secret) { source_address_token_secret_ = secret; }
+
+        // New-connection flood protection; see ChloGuardConfig. Must be set
+        // before InitializeServer().
+        void setMaxSessionsToCreatePerSocketEvent(size_t max_sessions) { max_sessions_per_socket_event_ = max_sessions; }
+        void setHandshakeRateLimit(double per_second, double burst)
+        {
+            chlo_config_.handshakes_per_second = per_second;
+            chlo_config_.handshake_burst = burst;
+        }
+        void setPerSourceRateLimit(double per_second, double burst)
+        {
+            chlo_config_.per_prefix_per_second = per_second;
+            chlo_config_.per_prefix_burst = burst;
+        }
+        void setSourcePrefixLengths(int ipv4_bits, int ipv6_bits)
+        {
+            chlo_config_.ipv4_prefix_length = ipv4_bits;
+            chlo_config_.ipv6_prefix_length = ipv6_bits;
+        }
+        void setMaxAdmittedWhileBuffering(size_t max_connections) { chlo_config_.max_admitted_while_buffering = max_connections; }
+        ChloStats chloStats() const { return server_ ? server_->chlo_stats() : ChloStats(); }
+
+        // Session admission control. Requests over a limit are refused with
+        // 429 when the CONNECT arrives, before any session state exists. Must
+        // be set before InitializeServer(); 0 disables a limit.
+        void setMaxSessions(size_t max_sessions) { admission_config_.max_sessions = max_sessions; }
+        void setMaxSessionsPerPath(const std::string &path, size_t max_sessions)
+        {
+            admission_config_.max_sessions_per_path[path] = max_sessions;
+        }
+        void setMaxNewSessionsPerSecond(double per_second, double burst)
+        {
+            admission_config_.new_sessions_per_second = per_second;
+            admission_config_.new_sessions_burst = burst;
+        }
+        // Refuses new sessions while the event loop runs later than this.
+        void setMaxEventLoopLag(uint64_t lag_ms) { admission_config_.max_event_loop_lag_ms = lag_ms; }
+        const SessionAdmission &admission() const { return admission_; }
+
+        // Live sessions, for walking them safely instead of holding on to
+        // session pointers. Event loop thread only.
+        const SessionRegistry &sessions() const { return sessions_; }
+        ServerSession *findSession(SessionId id) const { return sessions_.Find(id); }
+
+        // Named channels that fan one published payload out to many sessions.
+        // Channels may be published to from any thread; subscriptions are
+        // made on the event loop thread. The config applies to channels
+        // created after it is set.
+        void setChannelConfig(const ChannelConfig &config) { broadcaster_.set_config(config); }
+        Broadcaster &broadcaster() { return broadcaster_; }
+
+        // Topic publish/subscribe driven by clients over a control stream;
+        // see TopicRouter for the protocol. Publishing and subscriber counts
+        // work from any thread without locking the index.
+        void setTopicConfig(const TopicConfig &config) { topics_.set_config(config); }
+        TopicRouter &topics() { return topics_; }
 
         // Event handlers
         void onSession(SessionCallback cb) { session_cb_ = std::move(cb); }
+        // Sees the request headers before the response is sent and may add
+        // response headers, so negotiation can finish within the CONNECT.
+        void onSessionRequest(SessionRequestCallback cb) { session_request_cb_ = std::move(cb); }
+        // Replaces onSession with a decision that may take its time, e.g. an
+        // auth lookup, without blocking the event loop. The CONNECT response
+        // waits for the decision. Must be set before InitializeServer().
+        void onSessionDeferred(DeferredSessionCallback cb) { deferred_session_cb_ = std::move(cb); }
         void onUnidirectionalStream(UnidirectionalStreamCallback cb) { unidirectional_cb_ = std::move(cb); }
         void onBidirectionalStream(BidirectionalStreamCallback cb) { bidirectional_cb_ = std::move(cb); }
 
-        // Server lifecycle methods
-        void InitializeServer();
+        // Server lifecycle methods. InitializeServer() returns false if the
+        // certificates, ticket keys or listening socket can't be set up.
+        bool InitializeServer();
         void Listen();
 
     private:
@@ -56,21 +171,57 @@ namespace webtransport
         class StreamWrapper;
 
         // Create proof source for SSL/TLS
-        std::unique_ptr<quic::ProofSource> CreateProofSource();
+        std::unique_ptr<ServerProofSource> CreateProofSource();
+        std::shared_ptr<const CertificateSet> LoadCertificates(std::string *error);
+        std::unique_ptr<quic::ProofSource::TicketCrypter> CreateTicketCrypter();
+
+        // Applies accept/reject decisions posted by PendingSession handles.
+        class DecisionAlarmDelegate;
+        void ScheduleSessionDecisions();
+        void ApplySessionDecisions();
 
         // Server configuration
         std::string host_;
         uint16_t port_;
         std::string cert_file_;
         std::string key_file_;
+        std::mutex certificates_mutex_;
+        std::vector<std::pair<std::string, std::string>> certificate_files_;
+        std::vector<CertificatePem> certificates_;
+        size_t signing_threads_ = 0;
+        std::string ticket_key_file_;
+        TicketKeyProvider::KeySource ticket_key_cb_;
+        uint64_t ticket_key_rotation_secs_ = 3600;
+        std::shared_ptr<TicketKeyProvider> ticket_key_provider_;
+        // Empty until set: the per-process random secret is used.
+        std::string source_address_token_secret_;
+        ChloGuardConfig chlo_config_;
+        size_t max_sessions_per_socket_event_ = 0;
+        AdmissionConfig admission_config_;
+        // Outlives server_, whose sessions report to it when they close.
+        SessionAdmission admission_;
+        SessionRegistry sessions_;
+        Broadcaster broadcaster_{&sessions_};
+        // Runs on broadcaster_'s tick.
+        TopicRouter topics_{&sessions_, &broadcaster_};
+        std::shared_ptr<SessionDecisionQueue> session_decisions_ = std::make_shared<SessionDecisionQueue>();
+        std::map<SessionId, SessionWrapper *> pending_sessions_;
 
-        // QUIC server components
-        std::unique_ptr<quic::QuicServer> server_;
+        // QUIC server components. The backend outlives server_, whose streams
+        // hold on to it.
         std::unique_ptr<quic::WebTransportOnlyBackend> backend_;
+        std::unique_ptr<GuardedQuicServer> server_;
+        // Owned by server_.
+        ServerProofSource *proof_source_ = nullptr;
+        CertificateProofSource *certificate_source_ = nullptr;
         bool server_initialized_;
+        std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+        std::unique_ptr<quic::QuicAlarm> decision_alarm_;
 
         // Callbacks
         SessionCallback session_cb_;
+        SessionRequestCallback session_request_cb_;
+        DeferredSessionCallback deferred_session_cb_;
         UnidirectionalStreamCallback unidirectional_cb_;
         BidirectionalStreamCallback bidirectional_cb_;
 
@@ -0,0 +1,154 @@
+#include "web_transport_server_admission.h"
+
+#include <algorithm>
+#include <utility>
+#include "absl/strings/str_cat.h"
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        // How often the event loop's lateness is sampled.
+        constexpr int64_t kLagSampleIntervalMs = 50;
+
+    } // namespace
+
+    class SessionAdmission::LagAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+    {
+    public:
+        explicit LagAlarmDelegate(SessionAdmission *admission) : admission_(admission) {}
+
+        void OnAlarm() override { admission_->OnLagAlarm(); }
+
+    private:
+        SessionAdmission *admission_;
+    };
+
+    SessionAdmission::~SessionAdmission()
+    {
+        StopLagMonitor();
+    }
+
+    void SessionAdmission::set_config(AdmissionConfig config)
+    {
+        config_ = std::move(config);
+        // Tokens are capped at the burst, so a burst below 1 would refuse
+        // every session.
+        if (config_.new_sessions_burst < 1)
+        {
+            config_.new_sessions_burst = std::max(config_.new_sessions_per_second, 1.0);
+        }
+    }
+
+    void SessionAdmission::StopLagMonitor()
+    {
+        if (lag_alarm_)
+        {
+            lag_alarm_->Cancel();
+            lag_alarm_.reset();
+        }
+        alarm_factory_.reset();
+    }
+
+    void SessionAdmission::StartLagMonitor(quic::QuicEventLoop *event_loop)
+    {
+        clock_ = event_loop->GetClock();
+        tokens_ = config_.new_sessions_burst;
+        tokens_updated_ = clock_->Now();
+        if (config_.max_event_loop_lag_ms == 0)
+        {
+            return;
+        }
+
+        alarm_factory_ = event_loop->CreateAlarmFactory();
+        lag_alarm_.reset(alarm_factory_->CreateAlarm(new LagAlarmDelegate(this)));
+        lag_deadline_ = clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kLagSampleIntervalMs);
+        lag_alarm_->Set(lag_deadline_);
+    }
+
+    void SessionAdmission::OnLagAlarm()
+    {
+        quic::QuicTime now = clock_->Now();
+        quic::QuicTime::Delta sample = now > lag_deadline_ ? now - lag_deadline_
+                                                           : quic::QuicTime::Delta::Zero();
+        // Exponentially weighted, 1/4 per sample.
+        lag_ = lag_ * 0.75 + sample * 0.25;
+
+        lag_deadline_ = now + quic::QuicTime::Delta::FromMilliseconds(kLagSampleIntervalMs);
+        lag_alarm_->Set(lag_deadline_);
+    }
+
+    std::string SessionAdmission::PathKey(absl::string_view path)
+    {
+        return std::string(path.substr(0, path.find('?')));
+    }
+
+    size_t SessionAdmission::OpenOnPath(const std::string &key) const
+    {
+        auto it = open_per_path_.find(key);
+        return it == open_per_path_.end() ? 0 : it->second;
+    }
+
+    absl::Status SessionAdmission::Admit(absl::string_view path)
+    {
+        std::string key = PathKey(path);
+
+        absl::Status status = absl::OkStatus();
+        if (config_.max_sessions > 0 && open_sessions_ >= config_.max_sessions)
+        {
+            status = absl::ResourceExhaustedError("Too many sessions");
+        }
+        else if (auto limit = config_.max_sessions_per_path.find(key);
+                 limit != config_.max_sessions_per_path.end() && OpenOnPath(key) >= limit->second)
+        {
+            status = absl::ResourceExhaustedError(absl::StrCat("Too many sessions on ", key));
+        }
+        else if (config_.max_event_loop_lag_ms > 0 &&
+                 lag_ > quic::QuicTime::Delta::FromMilliseconds(config_.max_event_loop_lag_ms))
+        {
+            status = absl::ResourceExhaustedError("Server overloaded");
+        }
+        else if (config_.new_sessions_per_second > 0 && clock_ != nullptr)
+        {
+            quic::QuicTime now = clock_->ApproximateNow();
+            double elapsed = (now - tokens_updated_).ToMicroseconds() / 1e6;
+            tokens_ = std::min(config_.new_sessions_burst,
+                               tokens_ + elapsed * config_.new_sessions_per_second);
+            tokens_updated_ = now;
+            if (tokens_ < 1)
+            {
+                status = absl::ResourceExhaustedError("Session rate exceeded");
+            }
+            else
+            {
+                tokens_ -= 1;
+            }
+        }
+
+        if (!status.ok())
+        {
+            ++rejected_;
+            return status;
+        }
+        ++open_sessions_;
+        ++open_per_path_[key];
+        return status;
+    }
+
+    void SessionAdmission::OnSessionClosed(absl::string_view path)
+    {
+        std::string key = PathKey(path);
+        if (open_sessions_ > 0)
+        {
+            --open_sessions_;
+        }
+        auto it = open_per_path_.find(key);
+        if (it != open_per_path_.end() && --it->second == 0)
+        {
+            open_per_path_.erase(it);
+        }
+    }
+
+} // namespace webtransport
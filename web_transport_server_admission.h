@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/io/quic_event_loop.h"
+#include "quiche/quic/core/quic_alarm.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "quiche/quic/core/quic_time.h"
+
+namespace webtransport
+{
+
+    // Limits checked when a CONNECT request arrives. Zero disables a limit. A
+    // new_sessions_burst below 1 is taken as one second's worth of
+    // new_sessions_per_second (at least 1).
+    struct AdmissionConfig
+    {
+        size_t max_sessions = 0;
+        // Keyed by path without the query string.
+        std::map<std::string, size_t> max_sessions_per_path;
+        double new_sessions_per_second = 0;
+        double new_sessions_burst = 0;
+        // Shed new sessions while the event loop runs this far behind.
+        uint64_t max_event_loop_lag_ms = 0;
+    };
+
+    // SessionAdmission decides at CONNECT time whether a new session may be
+    // created, so a rejected request costs no per-session state. Rejections
+    // are answered with 429 by the backend. Event loop thread only.
+    class SessionAdmission
+    {
+    public:
+        SessionAdmission() = default;
+        ~SessionAdmission();
+
+        void set_config(AdmissionConfig config);
+        const AdmissionConfig &config() const { return config_; }
+
+        // Starts measuring how late the event loop runs its alarms; needed
+        // only for max_event_loop_lag_ms.
+        void StartLagMonitor(quic::QuicEventLoop *event_loop);
+        // Must be called before the event loop is destroyed.
+        void StopLagMonitor();
+
+        // Returns ResourceExhausted if a session for `path` must be refused,
+        // otherwise counts it as open.
+        absl::Status Admit(absl::string_view path);
+        void OnSessionClosed(absl::string_view path);
+
+        size_t open_sessions() const { return open_sessions_; }
+        quic::QuicTime::Delta event_loop_lag() const { return lag_; }
+        uint64_t rejected() const { return rejected_; }
+
+    private:
+        class LagAlarmDelegate;
+
+        static std::string PathKey(absl::string_view path);
+        size_t OpenOnPath(const std::string &key) const;
+        void OnLagAlarm();
+
+        AdmissionConfig config_;
+        size_t open_sessions_ = 0;
+        std::map<std::string, size_t> open_per_path_;
+        double tokens_ = 0;
+        quic::QuicTime tokens_updated_ = quic::QuicTime::Zero();
+        uint64_t rejected_ = 0;
+
+        const quic::QuicClock *clock_ = nullptr;
+        std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+        std::unique_ptr<quic::QuicAlarm> lag_alarm_;
+        quic::QuicTime lag_deadline_ = quic::QuicTime::Zero();
+        // Smoothed lateness of the lag alarm.
+        quic::QuicTime::Delta lag_ = quic::QuicTime::Delta::Zero();
+    };
+
+} // namespace webtransport
@@ -2,6 +2,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "quiche/quic/tools/quic_backend_response.h"
@@ -43,7 +44,7 @@ namespace quic
     }
 
     absl::StatusOr<std::unique_ptr<webtransport::SessionVisitor>> processed =
-        callback_(path->second, session, server_);
+        callback_(path->second, session, server_, request_headers, &response.response_headers);
     switch (processed.status().code())
     {
     case absl::StatusCode::kOk:
@@ -56,6 +57,12 @@ namespace quic
     case absl::StatusCode::kInvalidArgument:
       response.response_headers[":status"] = "400";
       return response;
+    case absl::StatusCode::kUnauthenticated:
+      response.response_headers[":status"] = "401";
+      return response;
+    case absl::StatusCode::kPermissionDenied:
+      response.response_headers[":status"] = "403";
+      return response;
     case absl::StatusCode::kResourceExhausted:
       response.response_headers[":status"] = "429";
       return response;
@@ -65,4 +72,99 @@ namespace quic
     }
   }
 
+  bool WebTransportOnlyBackend::SendHeldResponse(WebTransportSession *session,
+                                                 absl::string_view status)
+  {
+    auto it = held_responses_.find(session);
+    if (it == held_responses_.end())
+    {
+      return false;
+    }
+    WebTransportServerStream *stream = it->second;
+    held_responses_.erase(it);
+    stream->SendHeldResponse(status);
+    return true;
+  }
+
+  void WebTransportOnlyBackend::OnResponseHeld(WebTransportSession *session,
+                                               WebTransportServerStream *stream)
+  {
+    held_responses_[session] = stream;
+  }
+
+  void WebTransportOnlyBackend::OnResponseReleased(WebTransportSession *session)
+  {
+    held_responses_.erase(session);
+  }
+
+  WebTransportServerStream::WebTransportServerStream(QuicStreamId id, QuicSpdySession *session,
+                                                     StreamType type,
+                                                     WebTransportOnlyBackend *backend)
+      : QuicSimpleServerStream(id, session, type, backend), backend_(backend) {}
+
+  WebTransportServerStream::~WebTransportServerStream()
+  {
+    if (held_response_.has_value())
+    {
+      backend_->OnResponseReleased(web_transport());
+    }
+  }
+
+  size_t WebTransportServerStream::WriteHeaders(
+      quiche::HttpHeaderBlock header_block, bool fin,
+      quiche::QuicheReferenceCountedPointer<QuicAckListenerInterface> ack_listener)
+  {
+    // Only the 200 accepting a WebTransport session is held; refusals and
+    // anything else go out right away.
+    auto status = header_block.find(":status");
+    if (backend_->hold_responses() && web_transport() != nullptr && !fin &&
+        !held_response_.has_value() && status != header_block.end() && status->second == "200")
+    {
+      held_response_ = std::move(header_block);
+      backend_->OnResponseHeld(web_transport(), this);
+      return 0;
+    }
+    return QuicSimpleServerStream::WriteHeaders(std::move(header_block), fin,
+                                                std::move(ack_listener));
+  }
+
+  void WebTransportServerStream::SendHeldResponse(absl::string_view status)
+  {
+    if (!held_response_.has_value())
+    {
+      return;
+    }
+    quiche::HttpHeaderBlock headers = std::move(*held_response_);
+    held_response_.reset();
+    if (status == "200")
+    {
+      QuicSimpleServerStream::WriteHeaders(std::move(headers), /*fin=*/false, nullptr);
+      return;
+    }
+    headers[":status"] = status;
+    QuicSimpleServerStream::WriteHeaders(std::move(headers), /*fin=*/true, nullptr);
+    // Nothing the client sends on a refused session is read.
+    StopReading();
+  }
+
+  WebTransportServerSession::WebTransportServerSession(
+      const QuicConfig &config, const ParsedQuicVersionVector &supported_versions,
+      QuicConnection *connection, QuicSession::Visitor *visitor,
+      QuicCryptoServerStreamBase::Helper *helper, const QuicCryptoServerConfig *crypto_config,
+      QuicCompressedCertsCache *compressed_certs_cache, WebTransportOnlyBackend *backend)
+      : QuicSimpleServerSession(config, supported_versions, connection, visitor, helper,
+                                crypto_config, compressed_certs_cache, backend),
+        backend_(backend) {}
+
+  QuicSpdyStream *WebTransportServerSession::CreateIncomingStream(QuicStreamId id)
+  {
+    if (!ShouldCreateIncomingStream(id))
+    {
+      return nullptr;
+    }
+    QuicSpdyStream *stream = new WebTransportServerStream(id, this, BIDIRECTIONAL, backend_);
+    ActivateStream(absl::WrapUnique(stream));
+    return stream;
+  }
+
 } // namespace quic
@@ -1,13 +1,17 @@
 #ifndef QUICHE_QUIC_TOOLS_WEB_TRANSPORT_ONLY_BACKEND_H_
 #define QUICHE_QUIC_TOOLS_WEB_TRANSPORT_ONLY_BACKEND_H_
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/web_transport_interface.h"
 #include "quiche/quic/tools/quic_simple_server_backend.h"
+#include "quiche/quic/tools/quic_simple_server_session.h"
+#include "quiche/quic/tools/quic_simple_server_stream.h"
 #include "quiche/common/http/http_header_block.h"
 #include "quiche/common/quiche_callbacks.h"
 #include "quiche/web_transport/web_transport.h"
@@ -18,9 +22,16 @@ namespace quic
 
     // A callback to create a WebTransport session visitor for a given path and the
     // session object. The path includes both the path and the query.
+    // `request_headers` and `response_headers` are valid for the call only;
+    // headers added to `response_headers` are sent with the response, whatever
+    // its status.
     using WebTransportRequestCallback = quiche::MultiUseCallback<
         absl::StatusOr<std::unique_ptr<webtransport::SessionVisitor>>(
-            absl::string_view path, WebTransportSession *session, QuicServer *server)>;
+            absl::string_view path, WebTransportSession *session, QuicServer *server,
+            const quiche::HttpHeaderBlock &request_headers,
+            quiche::HttpHeaderBlock *response_headers)>;
+
+    class WebTransportServerStream;
 
     class WebTransportOnlyBackend : public QuicSimpleServerBackend
     {
@@ -30,6 +41,21 @@ namespace quic
 
         void SetServer(QuicServer *server) { server_ = server; }
 
+        // While set, the 200 answering a WebTransport CONNECT is kept back by
+        // its stream until SendHeldResponse(), so the session can still be
+        // refused with an HTTP status. Only streams created by a
+        // WebTransportServerSession can hold their response.
+        void SetHoldResponses(bool hold) { hold_responses_ = hold; }
+        bool hold_responses() const { return hold_responses_; }
+
+        // Sends the response held for `session` with `status`; any status but
+        // 200 also ends the CONNECT stream. Returns false if nothing is held.
+        bool SendHeldResponse(WebTransportSession *session, absl::string_view status);
+
+        // Called by WebTransportServerStream.
+        void OnResponseHeld(WebTransportSession *session, WebTransportServerStream *stream);
+        void OnResponseReleased(WebTransportSession *session);
+
         // QuicSimpleServerBackend implementation.
         bool InitializeBackend(const std::string &) override { return true; }
         bool IsBackendInitialized() const override { return true; }
@@ -45,6 +71,48 @@ namespace quic
     private:
         WebTransportRequestCallback callback_;
         QuicServer *server_;
+        bool hold_responses_ = false;
+        std::map<WebTransportSession *, WebTransportServerStream *> held_responses_;
+    };
+
+    // Server stream that can keep back the response to a WebTransport CONNECT
+    // while its backend holds responses.
+    class WebTransportServerStream : public QuicSimpleServerStream
+    {
+    public:
+        WebTransportServerStream(QuicStreamId id, QuicSpdySession *session, StreamType type,
+                                 WebTransportOnlyBackend *backend);
+        ~WebTransportServerStream() override;
+
+        size_t WriteHeaders(quiche::HttpHeaderBlock header_block, bool fin,
+                            quiche::QuicheReferenceCountedPointer<QuicAckListenerInterface>
+                                ack_listener) override;
+
+        // Writes the held response with `status` in place of its 200.
+        void SendHeldResponse(absl::string_view status);
+
+    private:
+        WebTransportOnlyBackend *backend_;
+        std::optional<quiche::HttpHeaderBlock> held_response_;
+    };
+
+    // Server session whose request streams are WebTransportServerStreams.
+    class WebTransportServerSession : public QuicSimpleServerSession
+    {
+    public:
+        WebTransportServerSession(const QuicConfig &config,
+                                  const ParsedQuicVersionVector &supported_versions,
+                                  QuicConnection *connection, QuicSession::Visitor *visitor,
+                                  QuicCryptoServerStreamBase::Helper *helper,
+                                  const QuicCryptoServerConfig *crypto_config,
+                                  QuicCompressedCertsCache *compressed_certs_cache,
+                                  WebTransportOnlyBackend *backend);
+
+    protected:
+        QuicSpdyStream *CreateIncomingStream(QuicStreamId id) override;
+
+    private:
+        WebTransportOnlyBackend *backend_;
     };
 
 } // namespace quic
@@ -0,0 +1,231 @@
+#include "web_transport_server_certs.h"
+
+#include <openssl/ssl.h>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/core/crypto/crypto_utils.h"
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        // Lower is preferred when several certificates cover the same name.
+        int KeyTypeRank(quic::PublicKeyType type)
+        {
+            switch (type)
+            {
+            case quic::PublicKeyType::kP256:
+                return 0;
+            case quic::PublicKeyType::kP384:
+            case quic::PublicKeyType::kEd25519:
+                return 1;
+            default:
+                return 2;
+            }
+        }
+
+    } // namespace
+
+    std::shared_ptr<const CertificateSet> CertificateSet::Create(
+        const std::vector<CertificatePem> &certificates, std::string *error)
+    {
+        if (certificates.empty())
+        {
+            *error = "No certificates configured";
+            return nullptr;
+        }
+
+        auto set = std::make_shared<CertificateSet>();
+        for (size_t i = 0; i < certificates.size(); ++i)
+        {
+            std::istringstream chain_stream(certificates[i].chain);
+            std::vector<std::string> certs = quic::CertificateView::LoadPemFromStream(&chain_stream);
+            if (certs.empty())
+            {
+                *error = absl::StrCat("Certificate ", i, ": no PEM certificates found");
+                return nullptr;
+            }
+
+            std::unique_ptr<quic::CertificateView> leaf =
+                quic::CertificateView::ParseSingleCertificate(certs[0]);
+            if (!leaf)
+            {
+                *error = absl::StrCat("Certificate ", i, ": failed to parse leaf certificate");
+                return nullptr;
+            }
+
+            std::istringstream key_stream(certificates[i].key);
+            std::unique_ptr<quic::CertificatePrivateKey> key =
+                quic::CertificatePrivateKey::LoadPemFromStream(&key_stream);
+            if (!key)
+            {
+                *error = absl::StrCat("Certificate ", i, ": failed to load private key");
+                return nullptr;
+            }
+            if (!key->MatchesPublicKey(*leaf))
+            {
+                *error = absl::StrCat("Certificate ", i, ": private key does not match certificate");
+                return nullptr;
+            }
+
+            auto entry = std::make_shared<Entry>();
+            entry->chain = quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain>(
+                new quic::ProofSource::Chain(certs));
+            entry->key = std::move(key);
+            entry->key_type = leaf->public_key_type();
+            if (entry->key_type == quic::PublicKeyType::kUnknown)
+            {
+                *error = absl::StrCat("Certificate ", i, ": unsupported public key type");
+                return nullptr;
+            }
+
+            for (absl::string_view name : leaf->subject_alt_name_domains())
+            {
+                std::string lower = absl::AsciiStrToLower(name);
+                auto &current = set->by_name_[lower];
+                if (!current || KeyTypeRank(entry->key_type) < KeyTypeRank(current->key_type))
+                {
+                    current = entry;
+                }
+            }
+            set->entries_.push_back(std::move(entry));
+        }
+        return set;
+    }
+
+    std::shared_ptr<const CertificateSet::Entry> CertificateSet::Lookup(
+        const std::string &hostname, bool *matched_sni) const
+    {
+        std::string name = absl::AsciiStrToLower(hostname);
+        auto it = by_name_.find(name);
+        if (it == by_name_.end())
+        {
+            size_t dot = name.find('.');
+            if (dot != std::string::npos)
+            {
+                it = by_name_.find(absl::StrCat("*", name.substr(dot)));
+            }
+        }
+
+        if (it != by_name_.end())
+        {
+            *matched_sni = true;
+            return it->second;
+        }
+        *matched_sni = false;
+        return entries_.front();
+    }
+
+    CertificateProofSource::CertificateProofSource(std::shared_ptr<const CertificateSet> certificates)
+        : certificates_(std::move(certificates)) {}
+
+    void CertificateProofSource::Update(std::shared_ptr<const CertificateSet> certificates)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        certificates_ = std::move(certificates);
+    }
+
+    std::shared_ptr<const CertificateSet> CertificateProofSource::GetCertificates() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return certificates_;
+    }
+
+    void CertificateProofSource::GetProof(const quic::QuicSocketAddress &server_address,
+                                          const quic::QuicSocketAddress &client_address,
+                                          const std::string &hostname,
+                                          const std::string &server_config,
+                                          quic::QuicTransportVersion transport_version,
+                                          absl::string_view chlo_hash,
+                                          std::unique_ptr<Callback> callback)
+    {
+        quic::QuicCryptoProof proof;
+        std::optional<std::string> payload =
+            quic::CryptoUtils::GenerateProofPayloadToBeSigned(chlo_hash, server_config);
+        if (!payload.has_value())
+        {
+            callback->Run(/*ok=*/false, nullptr, proof, nullptr);
+            return;
+        }
+
+        auto entry = GetCertificates()->Lookup(hostname, &proof.cert_matched_sni);
+        proof.signature = entry->key->Sign(*payload, SSL_SIGN_RSA_PSS_RSAE_SHA256);
+        callback->Run(/*ok=*/!proof.signature.empty(), entry->chain, proof, nullptr);
+    }
+
+    quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain>
+    CertificateProofSource::GetCertChain(const quic::QuicSocketAddress &server_address,
+                                         const quic::QuicSocketAddress &client_address,
+                                         const std::string &hostname, bool *cert_matched_sni)
+    {
+        auto entry = GetCertificates()->Lookup(hostname, cert_matched_sni);
+
+        // Remember the choice so the signature uses the same key even if the
+        // certificates are replaced before the handshake gets to sign.
+        std::string key = absl::StrCat(client_address.ToString(), "/", hostname);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = selected_.find(key);
+        if (it != selected_.end())
+        {
+            it->second.entry = entry;
+            selection_order_.splice(selection_order_.end(), selection_order_, it->second.order);
+        }
+        else
+        {
+            selection_order_.push_back(key);
+            selected_.emplace(std::move(key), Selection{entry, std::prev(selection_order_.end())});
+        }
+        if (selected_.size() > kMaxPendingSelections)
+        {
+            selected_.erase(selection_order_.front());
+            selection_order_.pop_front();
+        }
+        return entry->chain;
+    }
+
+    void CertificateProofSource::ComputeTlsSignature(
+        const quic::QuicSocketAddress &server_address,
+        const quic::QuicSocketAddress &client_address, const std::string &hostname,
+        uint16_t signature_algorithm, absl::string_view in,
+        std::unique_ptr<SignatureCallback> callback)
+    {
+        std::shared_ptr<const CertificateSet::Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = selected_.find(absl::StrCat(client_address.ToString(), "/", hostname));
+            if (it != selected_.end())
+            {
+                entry = std::move(it->second.entry);
+                selection_order_.erase(it->second.order);
+                selected_.erase(it);
+            }
+        }
+        if (!entry)
+        {
+            bool matched_sni;
+            entry = GetCertificates()->Lookup(hostname, &matched_sni);
+        }
+
+        if (!entry->key->ValidForSignatureAlgorithm(signature_algorithm))
+        {
+            callback->Run(/*ok=*/false, "", nullptr);
+            return;
+        }
+        std::string signature = entry->key->Sign(in, signature_algorithm);
+        bool ok = !signature.empty();
+        callback->Run(ok, std::move(signature), nullptr);
+    }
+
+    quic::QuicSignatureAlgorithmVector CertificateProofSource::SupportedTlsSignatureAlgorithms() const
+    {
+        // Let TLS pick from every algorithm the selected key supports.
+        return {};
+    }
+
+} // namespace webtransport
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/crypto/certificate_view.h"
+#include "quiche/quic/core/crypto/proof_source.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+
+namespace webtransport
+{
+
+    // A PEM certificate chain (leaf first) and the PEM private key of its leaf.
+    struct CertificatePem
+    {
+        std::string chain;
+        std::string key;
+    };
+
+    // CertificateSet is an immutable snapshot of the server's certificates,
+    // indexed by the DNS names in each leaf's subjectAltName. When a name has
+    // several certificates, ECDSA P-256 is preferred over other ECDSA curves
+    // and those over RSA: TLS 1.3 makes ecdsa_secp256r1_sha256 mandatory for
+    // clients, so every QUIC client can verify it, and signing is much cheaper.
+    class CertificateSet
+    {
+    public:
+        struct Entry
+        {
+            quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain> chain;
+            std::shared_ptr<const quic::CertificatePrivateKey> key;
+            quic::PublicKeyType key_type = quic::PublicKeyType::kUnknown;
+        };
+
+        // Parses and cross-checks every certificate and key. The first entry is
+        // served to clients whose SNI matches nothing. Returns nullptr and sets
+        // `error` if any pair is invalid.
+        static std::shared_ptr<const CertificateSet> Create(
+            const std::vector<CertificatePem> &certificates, std::string *error);
+
+        // Returns the entry for `hostname`, trying the exact name, then the
+        // wildcard for its parent domain, then the default entry.
+        std::shared_ptr<const Entry> Lookup(const std::string &hostname, bool *matched_sni) const;
+
+    private:
+        std::vector<std::shared_ptr<const Entry>> entries_;
+        std::map<std::string, std::shared_ptr<const Entry>> by_name_;
+    };
+
+    // CertificateProofSource serves a CertificateSet selected by SNI. The set
+    // can be replaced at any time from any thread; a handshake in progress
+    // signs with the key of the chain it was given.
+    class CertificateProofSource : public quic::ProofSource
+    {
+    public:
+        explicit CertificateProofSource(std::shared_ptr<const CertificateSet> certificates);
+        ~CertificateProofSource() override = default;
+
+        void Update(std::shared_ptr<const CertificateSet> certificates);
+
+        // quic::ProofSource implementation.
+        void OnNewSslCtx(SSL_CTX *ssl_ctx) override {}
+        void GetProof(const quic::QuicSocketAddress &server_address,
+                      const quic::QuicSocketAddress &client_address,
+                      const std::string &hostname, const std::string &server_config,
+                      quic::QuicTransportVersion transport_version,
+                      absl::string_view chlo_hash,
+                      std::unique_ptr<Callback> callback) override;
+        quiche::QuicheReferenceCountedPointer<Chain> GetCertChain(
+            const quic::QuicSocketAddress &server_address,
+            const quic::QuicSocketAddress &client_address,
+            const std::string &hostname, bool *cert_matched_sni) override;
+        void ComputeTlsSignature(const quic::QuicSocketAddress &server_address,
+                                 const quic::QuicSocketAddress &client_address,
+                                 const std::string &hostname, uint16_t signature_algorithm,
+                                 absl::string_view in,
+                                 std::unique_ptr<SignatureCallback> callback) override;
+        quic::QuicSignatureAlgorithmVector SupportedTlsSignatureAlgorithms() const override;
+        TicketCrypter *GetTicketCrypter() override { return nullptr; }
+
+    private:
+        // Bounds selected_ when handshakes fail before signing.
+        static constexpr size_t kMaxPendingSelections = 4096;
+
+        struct Selection
+        {
+            std::shared_ptr<const CertificateSet::Entry> entry;
+            // Position of the key in selection_order_.
+            std::list<std::string>::iterator order;
+        };
+
+        std::shared_ptr<const CertificateSet> GetCertificates() const;
+
+        mutable std::mutex mutex_;
+        std::shared_ptr<const CertificateSet> certificates_;
+        // Entry handed out by GetCertChain(), keyed by client address and SNI,
+        // until ComputeTlsSignature() consumes it.
+        std::map<std::string, Selection> selected_;
+        // Keys of selected_, oldest first.
+        std::list<std::string> selection_order_;
+    };
+
+} // namespace webtransport
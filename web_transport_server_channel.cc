@@ -0,0 +1,309 @@
+#include "web_transport_server_channel.h"
+
+#include <algorithm>
+#include <utility>
+#include "web_transport_server_session.h"
+
+namespace webtransport
+{
+
+    Channel::Channel(std::string name, const ChannelConfig &config, const SessionRegistry *sessions,
+                     Broadcaster *broadcaster)
+        : name_(std::move(name)), config_(config), sessions_(sessions), broadcaster_(broadcaster) {}
+
+    void Channel::Publish(Payload payload)
+    {
+        if (!payload || payload->empty())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(published_mutex_);
+            published_.push_back(std::move(payload));
+        }
+        if (broadcaster_ != nullptr)
+        {
+            broadcaster_->Wake();
+        }
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ++stats_.published;
+    }
+
+    void Channel::SubscribeDatagrams(SessionId session)
+    {
+        Subscriber subscriber;
+        subscriber.session = session;
+        Subscribe(std::move(subscriber));
+    }
+
+    void Channel::SubscribeStream(SessionId session, ServerStream *stream)
+    {
+        Subscriber subscriber;
+        subscriber.session = session;
+        subscriber.stream = stream;
+        subscriber.stream_lifetime = stream->lifetime();
+        Subscribe(std::move(subscriber));
+    }
+
+    void Channel::Subscribe(Subscriber subscriber)
+    {
+        auto it = subscriber_index_.find(subscriber.session);
+        if (it != subscriber_index_.end())
+        {
+            subscribers_[it->second] = std::move(subscriber);
+            return;
+        }
+        subscriber_index_[subscriber.session] = subscribers_.size();
+        subscribers_.push_back(std::move(subscriber));
+        if (broadcaster_ != nullptr)
+        {
+            broadcaster_->Activate();
+        }
+    }
+
+    void Channel::Unsubscribe(SessionId session)
+    {
+        auto it = subscriber_index_.find(session);
+        if (it != subscriber_index_.end())
+        {
+            RemoveAt(it->second);
+        }
+    }
+
+    void Channel::RemoveAt(size_t index)
+    {
+        subscriber_index_.erase(subscribers_[index].session);
+        if (index + 1 != subscribers_.size())
+        {
+            subscribers_[index] = std::move(subscribers_.back());
+            subscriber_index_[subscribers_[index].session] = index;
+        }
+        subscribers_.pop_back();
+    }
+
+    ChannelStats Channel::stats() const
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return stats_;
+    }
+
+    bool Channel::Deliver()
+    {
+        std::vector<Payload> payloads;
+        {
+            std::lock_guard<std::mutex> lock(published_mutex_);
+            payloads.swap(published_);
+        }
+
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t evicted = 0;
+
+        // Backwards, so removing the current subscriber skips nobody.
+        for (size_t i = subscribers_.size(); i > 0; --i)
+        {
+            // The eviction callback may have unsubscribed others.
+            if (i > subscribers_.size())
+            {
+                continue;
+            }
+            Subscriber &subscriber = subscribers_[i - 1];
+            ServerSession *session = sessions_->Find(subscriber.session);
+            if (session == nullptr ||
+                (subscriber.stream != nullptr && subscriber.stream_lifetime.expired()))
+            {
+                RemoveAt(i - 1);
+                continue;
+            }
+
+            if (subscriber.stream == nullptr)
+            {
+                for (const Payload &payload : payloads)
+                {
+                    session->SendDatagram(payload);
+                }
+                delivered += payloads.size();
+                continue;
+            }
+
+            if (!DeliverToStream(&subscriber, payloads, &delivered, &dropped))
+            {
+                SessionId id = subscriber.session;
+                RemoveAt(i - 1);
+                ++evicted;
+                if (evicted_cb_)
+                {
+                    evicted_cb_(id);
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.delivered += delivered;
+        stats_.dropped += dropped;
+        stats_.evicted += evicted;
+        stats_.subscribers = subscribers_.size();
+        return !subscribers_.empty();
+    }
+
+    bool Channel::DeliverToStream(Subscriber *subscriber, const std::vector<Payload> &payloads,
+                                  uint64_t *delivered, uint64_t *dropped)
+    {
+        // Older messages first, as far as the stream takes them.
+        while (!subscriber->queue.empty() && subscriber->stream->CanWrite())
+        {
+            if (!WriteMessage(subscriber->stream, subscriber->queue.front()))
+            {
+                break;
+            }
+            subscriber->queue.pop_front();
+            ++*delivered;
+        }
+        if (subscriber->queue.empty())
+        {
+            subscriber->drop_streak = 0;
+        }
+
+        for (const Payload &payload : payloads)
+        {
+            if (subscriber->queue.empty() && subscriber->stream->CanWrite() &&
+                WriteMessage(subscriber->stream, payload))
+            {
+                ++*delivered;
+                continue;
+            }
+            subscriber->queue.push_back(payload);
+            if (subscriber->queue.size() > config_.max_queued_messages)
+            {
+                subscriber->queue.pop_front();
+                ++*dropped;
+                ++subscriber->drop_streak;
+                if (config_.evict_after_drops > 0 && subscriber->drop_streak >= config_.evict_after_drops)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool Channel::WriteMessage(ServerStream *stream, const Payload &payload)
+    {
+        if (!config_.length_prefix)
+        {
+            return stream->Send(payload);
+        }
+        uint32_t size = static_cast<uint32_t>(payload->size());
+        auto prefix = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{
+            static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+            static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)});
+        return stream->Send(std::move(prefix), payload);
+    }
+
+    class Broadcaster::TickAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+    {
+    public:
+        explicit TickAlarmDelegate(Broadcaster *broadcaster) : broadcaster_(broadcaster) {}
+
+        void OnAlarm() override { broadcaster_->OnTick(); }
+
+    private:
+        Broadcaster *broadcaster_;
+    };
+
+    Broadcaster::~Broadcaster()
+    {
+        Stop();
+    }
+
+    void Broadcaster::Start(quic::QuicEventLoop *event_loop)
+    {
+        clock_ = event_loop->GetClock();
+        alarm_factory_ = event_loop->CreateAlarmFactory();
+        tick_alarm_.reset(alarm_factory_->CreateAlarm(new TickAlarmDelegate(this)));
+        tick_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kTickIntervalMs));
+    }
+
+    void Broadcaster::Stop()
+    {
+        if (tick_alarm_)
+        {
+            tick_alarm_->Cancel();
+            tick_alarm_.reset();
+        }
+        alarm_factory_.reset();
+    }
+
+    Channel *Broadcaster::GetOrCreateChannel(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex_);
+        auto &channel = channels_[name];
+        if (!channel)
+        {
+            channel = std::make_unique<Channel>(name, config_, sessions_, this);
+        }
+        return channel.get();
+    }
+
+    void Broadcaster::RemoveTickTask(TickTask *task)
+    {
+        tasks_.erase(std::remove(tasks_.begin(), tasks_.end(), task), tasks_.end());
+    }
+
+    Channel *Broadcaster::FindChannel(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex_);
+        auto it = channels_.find(name);
+        return it == channels_.end() ? nullptr : it->second.get();
+    }
+
+    void Broadcaster::Activate()
+    {
+        active_ = true;
+        if (tick_alarm_)
+        {
+            quic::QuicTime next = clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kTickIntervalMs);
+            if (!tick_alarm_->IsSet() || tick_alarm_->deadline() > next)
+            {
+                tick_alarm_->Update(next, quic::QuicTime::Delta::Zero());
+            }
+        }
+    }
+
+    void Broadcaster::OnTick()
+    {
+        quic::QuicTime now = clock_->Now();
+        // Channels only need a look while something was published or anyone
+        // is subscribed; the tasks run on every tick.
+        bool busy = work_pending_.exchange(false, std::memory_order_acquire) || active_;
+        if (busy)
+        {
+            std::vector<Channel *> channels;
+            {
+                std::lock_guard<std::mutex> lock(channels_mutex_);
+                channels.reserve(channels_.size());
+                for (auto &entry : channels_)
+                {
+                    channels.push_back(entry.second.get());
+                }
+            }
+            active_ = false;
+            for (Channel *channel : channels)
+            {
+                active_ = channel->Deliver() || active_;
+            }
+        }
+        for (TickTask *task : tasks_)
+        {
+            active_ = task->OnTick(now) || active_;
+        }
+        // A subscription can be made from a delivery callback, which already
+        // re-armed the alarm.
+        int64_t interval_ms = active_ ? kTickIntervalMs : kIdleTickIntervalMs;
+        if (!tick_alarm_->IsSet())
+        {
+            tick_alarm_->Set(now + quic::QuicTime::Delta::FromMilliseconds(interval_ms));
+        }
+    }
+
+} // namespace webtransport
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "quiche/quic/core/io/quic_event_loop.h"
+#include "quiche/quic/core/quic_alarm.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/core/quic_time.h"
+#include "web_transport_server_registry.h"
+#include "web_transport_server_stream.h"
+
+namespace webtransport
+{
+
+    class Broadcaster;
+
+    struct ChannelConfig
+    {
+        // Messages held per stream subscriber while its stream is blocked;
+        // the oldest is dropped when a new one does not fit.
+        size_t max_queued_messages = 64;
+        // Consecutive drops after which a stream subscriber is evicted;
+        // 0 never evicts.
+        size_t evict_after_drops = 32;
+        // Prefix each message on a stream with its 4-byte big-endian
+        // length, so receivers can split them.
+        bool length_prefix = true;
+    };
+
+    struct ChannelStats
+    {
+        uint64_t published = 0;
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t evicted = 0;
+        size_t subscribers = 0;
+    };
+
+    // Channel fans each published payload out to its subscribers, as a
+    // datagram or on a stream the subscriber chose. The payload is shared,
+    // not copied, between stream subscribers. Publish() may be called from
+    // any thread; everything else runs on the event loop thread.
+    class Channel
+    {
+    public:
+        using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+        // A slow stream subscriber was dropped from the channel.
+        using EvictionCallback = std::function<void(SessionId)>;
+
+        // `broadcaster` is woken by Publish() and switched to full-rate ticks
+        // by new subscriptions; it may be null.
+        Channel(std::string name, const ChannelConfig &config, const SessionRegistry *sessions,
+                Broadcaster *broadcaster = nullptr);
+
+        const std::string &name() const { return name_; }
+
+        void Publish(Payload payload);
+
+        // Replaces any earlier subscription of the same session. `stream`
+        // must belong to the session.
+        void SubscribeDatagrams(SessionId session);
+        void SubscribeStream(SessionId session, ServerStream *stream);
+        void Unsubscribe(SessionId session);
+
+        void onEvicted(EvictionCallback cb) { evicted_cb_ = std::move(cb); }
+
+        ChannelStats stats() const;
+
+    private:
+        friend class Broadcaster;
+
+        struct Subscriber
+        {
+            SessionId session = 0;
+            // Null for datagram delivery.
+            ServerStream *stream = nullptr;
+            std::weak_ptr<const void> stream_lifetime;
+            std::deque<Payload> queue;
+            size_t drop_streak = 0;
+        };
+
+        void Subscribe(Subscriber subscriber);
+        void RemoveAt(size_t index);
+        // Delivers what was published since the last call, and whatever
+        // blocked streams can now take. Returns true while the channel has
+        // subscribers.
+        bool Deliver();
+        // Returns false if `subscriber` must be evicted.
+        bool DeliverToStream(Subscriber *subscriber, const std::vector<Payload> &payloads,
+                             uint64_t *delivered, uint64_t *dropped);
+        // Writes the prefix and payload together, or nothing.
+        bool WriteMessage(ServerStream *stream, const Payload &payload);
+
+        std::string name_;
+        ChannelConfig config_;
+        const SessionRegistry *sessions_;
+        Broadcaster *broadcaster_;
+
+        std::mutex published_mutex_;
+        std::vector<Payload> published_;
+
+        std::vector<Subscriber> subscribers_;
+        std::unordered_map<SessionId, size_t> subscriber_index_;
+        EvictionCallback evicted_cb_;
+
+        mutable std::mutex stats_mutex_;
+        ChannelStats stats_;
+    };
+
+    // Work run on the broadcaster's tick, so that it needs no alarm of its
+    // own. A task with subscribers keeps the ticks at full rate, and calls
+    // Broadcaster::Activate() when it gains its first one.
+    class TickTask
+    {
+    public:
+        virtual ~TickTask() = default;
+        // Event loop thread, on every tick, idle ones included. Returns true
+        // while the task needs full-rate ticks.
+        virtual bool OnTick(quic::QuicTime now) = 0;
+    };
+
+    // Broadcaster owns the channels of a server and runs their fan-out on
+    // the event loop. It ticks every millisecond while any channel or tick
+    // task has subscribers, since Publish() cannot wake the event loop; with
+    // nobody subscribed it only checks every kIdleTickIntervalMs, to discard
+    // what was published meanwhile. Channels live as long as the broadcaster.
+    class Broadcaster
+    {
+    public:
+        static constexpr int64_t kTickIntervalMs = 1;
+        static constexpr int64_t kIdleTickIntervalMs = 20;
+
+        explicit Broadcaster(const SessionRegistry *sessions) : sessions_(sessions) {}
+        ~Broadcaster();
+
+        void set_config(const ChannelConfig &config) { config_ = config; }
+
+        // Must be called on the event loop thread before it runs, and Stop()
+        // before it is destroyed.
+        void Start(quic::QuicEventLoop *event_loop);
+        void Stop();
+
+        // Any thread. New channels take the current config.
+        Channel *GetOrCreateChannel(const std::string &name);
+        Channel *FindChannel(const std::string &name);
+
+        // Any thread. Makes the next tick deliver.
+        void Wake() { work_pending_.store(true, std::memory_order_release); }
+        // Event loop thread. Brings the next tick forward to full rate, for a
+        // new subscriber.
+        void Activate();
+
+        // Event loop thread, or before Start().
+        void AddTickTask(TickTask *task) { tasks_.push_back(task); }
+        void RemoveTickTask(TickTask *task);
+
+    private:
+        class TickAlarmDelegate;
+        void OnTick();
+
+        const SessionRegistry *sessions_;
+        ChannelConfig config_;
+
+        std::mutex channels_mutex_;
+        std::map<std::string, std::unique_ptr<Channel>> channels_;
+        std::vector<TickTask *> tasks_;
+
+        const quic::QuicClock *clock_ = nullptr;
+        std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+        std::unique_ptr<quic::QuicAlarm> tick_alarm_;
+        std::atomic<bool> work_pending_{false};
+        // Some channel had subscribers at the last delivery.
+        bool active_ = false;
+    };
+
+} // namespace webtransport
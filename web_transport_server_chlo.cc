@@ -0,0 +1,238 @@
+#include "web_transport_server_chlo.h"
+
+#include <algorithm>
+#include <utility>
+#include "quiche/quic/core/proto/cached_network_parameters_proto.h"
+#include "quiche/quic/core/proto/source_address_token_proto.h"
+#include "quiche/quic/core/quic_default_clock.h"
+#include "quiche/quic/core/quic_connection.h"
+#include "quiche/quic/core/quic_default_connection_helper.h"
+#include "quiche/quic/core/quic_dispatcher.h"
+#include "quiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        double EffectiveBurst(double rate, double burst)
+        {
+            return burst >= 1 ? burst : std::max(rate, 1.0);
+        }
+
+    } // namespace
+
+    ChloGuard::ChloGuard(const ChloGuardConfig &config, const quic::QuicClock *clock)
+        : config_(config), clock_(clock)
+    {
+        config_.handshake_burst = EffectiveBurst(config_.handshakes_per_second, config_.handshake_burst);
+        config_.per_prefix_burst = EffectiveBurst(config_.per_prefix_per_second, config_.per_prefix_burst);
+        handshakes_.tokens = config_.handshake_burst;
+        handshakes_.updated = clock_->ApproximateNow();
+    }
+
+    bool ChloGuard::Admit(const quic::QuicSocketAddress &peer_address, bool validated,
+                          bool chlos_buffered)
+    {
+        quic::QuicTime now = clock_->ApproximateNow();
+
+        if (!chlos_buffered)
+        {
+            stats_.admitted_while_buffering = 0;
+        }
+        if (config_.max_admitted_while_buffering > 0 &&
+            stats_.admitted_while_buffering >= config_.max_admitted_while_buffering)
+        {
+            ++stats_.dropped_while_buffering;
+            return false;
+        }
+
+        if (config_.per_prefix_per_second > 0)
+        {
+            std::string key = PrefixKey(peer_address.host());
+            auto it = prefixes_.find(key);
+            if (it == prefixes_.end())
+            {
+                if (prefixes_.size() >= kMaxTrackedPrefixes)
+                {
+                    PruneFullBuckets(now);
+                }
+                Bucket bucket;
+                bucket.tokens = config_.per_prefix_burst;
+                bucket.updated = now;
+                it = prefixes_.emplace(std::move(key), bucket).first;
+            }
+            if (!Take(&it->second, config_.per_prefix_per_second, config_.per_prefix_burst, now))
+            {
+                ++stats_.dropped_prefix_limit;
+                return false;
+            }
+            stats_.tracked_prefixes = prefixes_.size();
+        }
+
+        // Clients that proved their address earlier bypass the global rate;
+        // everyone else shares it.
+        if (config_.handshakes_per_second > 0 && !validated &&
+            !Take(&handshakes_, config_.handshakes_per_second, config_.handshake_burst, now))
+        {
+            ++stats_.dropped_unvalidated;
+            return false;
+        }
+
+        ++stats_.admitted;
+        if (validated)
+        {
+            ++stats_.admitted_validated;
+        }
+        ++stats_.admitted_while_buffering;
+        return true;
+    }
+
+    bool ChloGuard::Take(Bucket *bucket, double rate, double burst, quic::QuicTime now)
+    {
+        double elapsed = (now - bucket->updated).ToMicroseconds() / 1e6;
+        bucket->tokens = std::min(burst, bucket->tokens + elapsed * rate);
+        bucket->updated = now;
+        if (bucket->tokens < 1)
+        {
+            return false;
+        }
+        bucket->tokens -= 1;
+        return true;
+    }
+
+    std::string ChloGuard::PrefixKey(const quic::QuicIpAddress &address) const
+    {
+        std::string packed = address.ToPackedString();
+        int prefix_length = address.IsIPv6() ? config_.ipv6_prefix_length
+                                             : config_.ipv4_prefix_length;
+        size_t full_bytes = std::min(packed.size(), static_cast<size_t>(prefix_length / 8));
+        std::string key = packed.substr(0, full_bytes);
+        int remaining_bits = prefix_length % 8;
+        if (remaining_bits > 0 && full_bytes < packed.size())
+        {
+            uint8_t mask = static_cast<uint8_t>(0xff << (8 - remaining_bits));
+            key.push_back(static_cast<char>(static_cast<uint8_t>(packed[full_bytes]) & mask));
+        }
+        // Keep IPv4 and IPv6 prefixes of equal bytes apart.
+        key.push_back(address.IsIPv6() ? '6' : '4');
+        return key;
+    }
+
+    void ChloGuard::PruneFullBuckets(quic::QuicTime now)
+    {
+        for (auto it = prefixes_.begin(); it != prefixes_.end();)
+        {
+            double elapsed = (now - it->second.updated).ToMicroseconds() / 1e6;
+            if (it->second.tokens + elapsed * config_.per_prefix_per_second >= config_.per_prefix_burst)
+            {
+                it = prefixes_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    GuardedDispatcher::GuardedDispatcher(
+        const quic::QuicConfig *config, const quic::QuicCryptoServerConfig *crypto_config,
+        quic::QuicVersionManager *version_manager,
+        std::unique_ptr<quic::QuicConnectionHelperInterface> helper,
+        std::unique_ptr<quic::QuicCryptoServerStreamBase::Helper> session_helper,
+        std::unique_ptr<quic::QuicAlarmFactory> alarm_factory,
+        quic::WebTransportOnlyBackend *backend, uint8_t expected_server_connection_id_length,
+        quic::ConnectionIdGeneratorInterface &generator, ChloGuard *guard)
+        : quic::QuicSimpleDispatcher(config, crypto_config, version_manager, std::move(helper),
+                                     std::move(session_helper), std::move(alarm_factory),
+                                     backend, expected_server_connection_id_length, generator),
+          crypto_config_(crypto_config),
+          backend_(backend),
+          guard_(guard) {}
+
+    quic::QuicDispatcher::QuicPacketFate GuardedDispatcher::ValidityChecks(
+        const quic::ReceivedPacketInfo &packet_info)
+    {
+        QuicPacketFate fate = quic::QuicSimpleDispatcher::ValidityChecks(packet_info);
+        if (fate != kFateProcess)
+        {
+            return fate;
+        }
+
+        // Only Initial packets can start a connection; anything else for an
+        // unknown connection is handled by quiche as before.
+        if (packet_info.form != quic::IETF_QUIC_LONG_HEADER_PACKET ||
+            packet_info.long_packet_type != quic::INITIAL)
+        {
+            return fate;
+        }
+
+        if (!guard_->Admit(packet_info.peer_address, IsValidAddressToken(packet_info),
+                           HasChlosBuffered()))
+        {
+            // Dropped without state; the client's Initial retransmission backs
+            // off on its own.
+            return kFateDrop;
+        }
+        return fate;
+    }
+
+    std::unique_ptr<quic::QuicSession> GuardedDispatcher::CreateQuicSession(
+        quic::QuicConnectionId connection_id, const quic::QuicSocketAddress &self_address,
+        const quic::QuicSocketAddress &peer_address, absl::string_view /*alpn*/,
+        const quic::ParsedQuicVersion &version, const quic::ParsedClientHello & /*parsed_chlo*/,
+        quic::ConnectionIdGeneratorInterface &connection_id_generator)
+    {
+        // The session takes ownership of the connection.
+        auto *connection = new quic::QuicConnection(
+            connection_id, self_address, peer_address, helper(), alarm_factory(), writer(),
+            /*owns_writer=*/false, quic::Perspective::IS_SERVER,
+            quic::ParsedQuicVersionVector{version}, connection_id_generator);
+        auto session = std::make_unique<quic::WebTransportServerSession>(
+            config(), GetSupportedVersions(), connection, this, session_helper(),
+            crypto_config_, compressed_certs_cache(), backend_);
+        session->Initialize();
+        return session;
+    }
+
+    bool GuardedDispatcher::IsValidAddressToken(const quic::ReceivedPacketInfo &packet_info)
+    {
+        if (packet_info.retry_token.empty())
+        {
+            return false;
+        }
+
+        quic::SourceAddressTokens tokens;
+        if (crypto_config_->ParseSourceAddressToken(crypto_config_->source_address_token_boxer(),
+                                                    packet_info.retry_token,
+                                                    tokens) != quic::HANDSHAKE_OK)
+        {
+            return false;
+        }
+        quic::CachedNetworkParameters cached_network_params;
+        return crypto_config_->ValidateSourceAddressTokens(
+                   tokens, packet_info.peer_address.host(), helper()->GetClock()->WallNow(),
+                   &cached_network_params) == quic::HANDSHAKE_OK;
+    }
+
+    GuardedQuicServer::GuardedQuicServer(std::unique_ptr<quic::ProofSource> proof_source,
+                                         quic::WebTransportOnlyBackend *backend,
+                                         absl::string_view source_address_token_secret,
+                                         const ChloGuardConfig &config)
+        : quic::QuicServer(std::move(proof_source), backend, source_address_token_secret),
+          backend_(backend),
+          guard_(config, quic::QuicDefaultClock::Get()) {}
+
+    quic::QuicDispatcher *GuardedQuicServer::CreateQuicDispatcher()
+    {
+        return new GuardedDispatcher(
+            &config(), &crypto_config(), version_manager(),
+            std::make_unique<quic::QuicDefaultConnectionHelper>(),
+            std::unique_ptr<quic::QuicCryptoServerStreamBase::Helper>(
+                new quic::QuicSimpleCryptoServerStreamHelper()),
+            event_loop()->CreateAlarmFactory(), backend_,
+            expected_server_connection_id_length(), connection_id_generator(), &guard_);
+    }
+
+} // namespace webtransport
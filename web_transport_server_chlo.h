@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "quiche/quic/core/crypto/quic_crypto_server_config.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+#include "quiche/quic/tools/quic_simple_dispatcher.h"
+#include "web_transport_server_backend.h"
+#include "web_transport_server_core.h"
+
+namespace webtransport
+{
+
+    // Limits applied to packets that would start a new connection. A rate of
+    // zero disables the corresponding check. A burst below 1 would refuse
+    // every connection, so it is taken as one second's worth of the rate
+    // (at least 1) instead.
+    struct ChloGuardConfig
+    {
+        // New connections per second before address validation is required:
+        // beyond it, Initial packets are only admitted if they carry a valid
+        // address token from an earlier connection (NEW_TOKEN).
+        double handshakes_per_second = 0;
+        double handshake_burst = 0;
+
+        // Token bucket per source prefix (/24 for IPv4, /56 for IPv6).
+        double per_prefix_per_second = 0;
+        double per_prefix_burst = 0;
+        int ipv4_prefix_length = 24;
+        int ipv6_prefix_length = 56;
+
+        // Upper bound on new connections admitted while the dispatcher still
+        // has CHLOs waiting for session creation; 0 leaves it to quiche.
+        // quiche does not expose how many CHLOs it buffers, so this counts
+        // every connection admitted since the buffer was last seen empty,
+        // including ones whose sessions were created meanwhile. It bounds
+        // the real buffer from above, not exactly.
+        size_t max_admitted_while_buffering = 0;
+    };
+
+    // Counters for the packets ChloGuard has seen since the server started.
+    struct ChloStats
+    {
+        uint64_t admitted = 0;
+        uint64_t admitted_validated = 0;
+        uint64_t dropped_prefix_limit = 0;
+        uint64_t dropped_unvalidated = 0;
+        uint64_t dropped_while_buffering = 0;
+        // New connections admitted since the CHLO buffer was last seen empty;
+        // see ChloGuardConfig::max_admitted_while_buffering.
+        size_t admitted_while_buffering = 0;
+        size_t tracked_prefixes = 0;
+    };
+
+    // ChloGuard decides whether a packet for an unknown connection may start
+    // one. It runs on the event loop thread only.
+    class ChloGuard
+    {
+    public:
+        ChloGuard(const ChloGuardConfig &config, const quic::QuicClock *clock);
+
+        // `validated` is true if the packet carried a valid address token.
+        // `chlos_buffered` reports whether the dispatcher has CHLOs queued.
+        bool Admit(const quic::QuicSocketAddress &peer_address, bool validated,
+                   bool chlos_buffered);
+
+        const ChloStats &stats() const { return stats_; }
+
+    private:
+        // Bounds prefixes_ during a spoofed-source flood.
+        static constexpr size_t kMaxTrackedPrefixes = 1 << 16;
+
+        struct Bucket
+        {
+            double tokens = 0;
+            quic::QuicTime updated = quic::QuicTime::Zero();
+        };
+
+        // Refills `bucket` and takes a token if one is available.
+        bool Take(Bucket *bucket, double rate, double burst, quic::QuicTime now);
+        std::string PrefixKey(const quic::QuicIpAddress &address) const;
+        void PruneFullBuckets(quic::QuicTime now);
+
+        ChloGuardConfig config_;
+        const quic::QuicClock *clock_;
+        Bucket handshakes_;
+        std::unordered_map<std::string, Bucket> prefixes_;
+        ChloStats stats_;
+    };
+
+    // Dispatcher that runs every would-be new connection past a ChloGuard
+    // before quiche buffers its CHLO or creates a session. Sessions are
+    // WebTransportServerSessions, so CONNECT responses can be held.
+    class GuardedDispatcher : public quic::QuicSimpleDispatcher
+    {
+    public:
+        GuardedDispatcher(const quic::QuicConfig *config,
+                          const quic::QuicCryptoServerConfig *crypto_config,
+                          quic::QuicVersionManager *version_manager,
+                          std::unique_ptr<quic::QuicConnectionHelperInterface> helper,
+                          std::unique_ptr<quic::QuicCryptoServerStreamBase::Helper> session_helper,
+                          std::unique_ptr<quic::QuicAlarmFactory> alarm_factory,
+                          quic::WebTransportOnlyBackend *backend,
+                          uint8_t expected_server_connection_id_length,
+                          quic::ConnectionIdGeneratorInterface &generator,
+                          ChloGuard *guard);
+
+    protected:
+        QuicPacketFate ValidityChecks(const quic::ReceivedPacketInfo &packet_info) override;
+        std::unique_ptr<quic::QuicSession> CreateQuicSession(
+            quic::QuicConnectionId connection_id, const quic::QuicSocketAddress &self_address,
+            const quic::QuicSocketAddress &peer_address, absl::string_view alpn,
+            const quic::ParsedQuicVersion &version, const quic::ParsedClientHello &parsed_chlo,
+            quic::ConnectionIdGeneratorInterface &connection_id_generator) override;
+
+    private:
+        bool IsValidAddressToken(const quic::ReceivedPacketInfo &packet_info);
+
+        const quic::QuicCryptoServerConfig *crypto_config_;
+        quic::WebTransportOnlyBackend *backend_;
+        ChloGuard *guard_;
+    };
+
+    // QuicServer whose dispatcher applies a ChloGuard.
+    class GuardedQuicServer : public quic::QuicServer
+    {
+    public:
+        GuardedQuicServer(std::unique_ptr<quic::ProofSource> proof_source,
+                          quic::WebTransportOnlyBackend *backend,
+                          absl::string_view source_address_token_secret,
+                          const ChloGuardConfig &config);
+
+        const ChloStats &chlo_stats() const { return guard_.stats(); }
+
+    protected:
+        quic::QuicDispatcher *CreateQuicDispatcher() override;
+
+    private:
+        quic::WebTransportOnlyBackend *backend_;
+        ChloGuard guard_;
+    };
+
+} // namespace webtransport
@@ -21,7 +21,7 @@
 #include "quiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
 #include "quiche/quic/tools/quic_simple_dispatcher.h"
 #include "quiche/quic/tools/quic_simple_server_backend.h"
-#include "quiche/common/simple_buffer_allocator.h"
+#include "quiche_platform_impl/quiche_stream_buffer_allocator_impl.h"
 
 namespace quic
 {
@@ -45,21 +45,31 @@ namespace quic
                          const ParsedQuicVersionVector &supported_versions)
       : QuicServer(std::move(proof_source), QuicConfig(),
                    QuicCryptoServerConfig::ConfigOptions(), supported_versions,
-                   quic_simple_server_backend, kQuicDefaultConnectionIdLength) {}
+                   quic_simple_server_backend, kQuicDefaultConnectionIdLength,
+                   kSourceAddressTokenSecret) {}
+
+  QuicServer::QuicServer(std::unique_ptr<ProofSource> proof_source,
+                         QuicSimpleServerBackend *quic_simple_server_backend,
+                         absl::string_view source_address_token_secret)
+      : QuicServer(std::move(proof_source), QuicConfig(),
+                   QuicCryptoServerConfig::ConfigOptions(), AllSupportedVersions(),
+                   quic_simple_server_backend, kQuicDefaultConnectionIdLength,
+                   source_address_token_secret) {}
 
   QuicServer::QuicServer(
       std::unique_ptr<ProofSource> proof_source, const QuicConfig &config,
       const QuicCryptoServerConfig::ConfigOptions &crypto_config_options,
       const ParsedQuicVersionVector &supported_versions,
       QuicSimpleServerBackend *quic_simple_server_backend,
-      uint8_t expected_server_connection_id_length)
+      uint8_t expected_server_connection_id_length,
+      absl::string_view source_address_token_secret)
       : port_(0),
         fd_(-1),
         packets_dropped_(0),
         overflow_supported_(false),
         silent_close_(false),
         config_(config),
-        crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance(),
+        crypto_config_(source_address_token_secret, QuicRandom::GetInstance(),
                        std::move(proof_source), KeyExchangeSource::Default()),
         crypto_config_options_(crypto_config_options),
         version_manager_(supported_versions),
@@ -122,7 +132,7 @@ namespace quic
     event_loop_ = CreateEventLoop();
 
     socket_factory_ = std::make_unique<EventLoopSocketFactory>(
-        event_loop_.get(), quiche::SimpleBufferAllocator::Get());
+        event_loop_.get(), quiche::QuicheStreamBufferAllocatorImpl::Get());
     quic_simple_server_backend_->SetSocketFactory(socket_factory_.get());
 
     QuicUdpSocketApi socket_api;
@@ -36,12 +36,18 @@ namespace quic
     QuicServer(std::unique_ptr<ProofSource> proof_source,
                QuicSimpleServerBackend *quic_simple_server_backend,
                const ParsedQuicVersionVector &supported_versions);
+    // `source_address_token_secret` keys the address tokens handed to clients;
+    // servers behind one load balancer should share it.
+    QuicServer(std::unique_ptr<ProofSource> proof_source,
+               QuicSimpleServerBackend *quic_simple_server_backend,
+               absl::string_view source_address_token_secret);
     QuicServer(std::unique_ptr<ProofSource> proof_source,
                const QuicConfig &config,
                const QuicCryptoServerConfig::ConfigOptions &crypto_config_options,
                const ParsedQuicVersionVector &supported_versions,
                QuicSimpleServerBackend *quic_simple_server_backend,
-               uint8_t expected_server_connection_id_length);
+               uint8_t expected_server_connection_id_length,
+               absl::string_view source_address_token_secret);
     QuicServer(const QuicServer &) = delete;
     QuicServer &operator=(const QuicServer &) = delete;
 
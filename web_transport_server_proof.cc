@@ -0,0 +1,211 @@
+#include "web_transport_server_proof.h"
+
+#include <utility>
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        // How often the signing pool is checked for finished signatures.
+        constexpr int64_t kPollIntervalMs = 1;
+
+        // Captures the result of a delegate that signs synchronously.
+        class CapturingSignatureCallback : public quic::ProofSource::SignatureCallback
+        {
+        public:
+            explicit CapturingSignatureCallback(SigningPool::Signature *result) : result_(result) {}
+
+            void Run(bool ok, std::string signature,
+                     std::unique_ptr<quic::ProofSource::Details> /*details*/) override
+            {
+                result_->ok = ok;
+                result_->signature = std::move(signature);
+            }
+
+        private:
+            SigningPool::Signature *result_;
+        };
+
+    } // namespace
+
+    class SigningPool::PollAlarmDelegate : public quic::QuicAlarm::DelegateWithoutContext
+    {
+    public:
+        explicit PollAlarmDelegate(SigningPool *pool) : pool_(pool) {}
+
+        void OnAlarm() override { pool_->DeliverResults(); }
+
+    private:
+        SigningPool *pool_;
+    };
+
+    SigningPool::SigningPool(quic::QuicEventLoop *event_loop, size_t num_threads)
+        : clock_(event_loop->GetClock()),
+          alarm_factory_(event_loop->CreateAlarmFactory())
+    {
+        poll_alarm_.reset(alarm_factory_->CreateAlarm(new PollAlarmDelegate(this)));
+        for (size_t i = 0; i < num_threads; ++i)
+        {
+            threads_.emplace_back([this]()
+                                  { WorkerLoop(); });
+        }
+    }
+
+    SigningPool::~SigningPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_available_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+        poll_alarm_->Cancel();
+    }
+
+    void SigningPool::Post(std::function<Signature()> sign,
+                           std::unique_ptr<quic::ProofSource::SignatureCallback> callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(Task{std::move(sign), std::move(callback)});
+        }
+        work_available_.notify_one();
+
+        ++outstanding_;
+        if (!poll_alarm_->IsSet())
+        {
+            poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+        }
+    }
+
+    void SigningPool::WorkerLoop()
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_available_.wait(lock, [this]()
+                                     { return stopping_ || !tasks_.empty(); });
+                if (stopping_)
+                {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            Signature signature = task.sign();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.emplace_back(std::move(task), std::move(signature));
+        }
+    }
+
+    void SigningPool::DeliverResults()
+    {
+        std::vector<std::pair<Task, Signature>> results;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results.swap(results_);
+        }
+
+        outstanding_ -= results.size();
+        for (auto &[task, signature] : results)
+        {
+            // Resumes the handshake; a no-op if the connection is gone.
+            task.callback->Run(signature.ok, std::move(signature.signature), nullptr);
+        }
+
+        if (outstanding_ > 0)
+        {
+            poll_alarm_->Set(clock_->Now() + quic::QuicTime::Delta::FromMilliseconds(kPollIntervalMs));
+        }
+    }
+
+    ServerProofSource::ServerProofSource(std::unique_ptr<quic::ProofSource> delegate)
+        : delegate_(std::move(delegate)) {}
+
+    void ServerProofSource::SetTicketCrypter(std::unique_ptr<TicketCrypter> ticket_crypter)
+    {
+        ticket_crypter_ = std::move(ticket_crypter);
+    }
+
+    void ServerProofSource::StartSigningPool(quic::QuicEventLoop *event_loop, size_t num_threads)
+    {
+        if (num_threads == 0)
+        {
+            signing_pool_.reset();
+            return;
+        }
+        signing_pool_ = std::make_unique<SigningPool>(event_loop, num_threads);
+    }
+
+    void ServerProofSource::OnNewSslCtx(SSL_CTX *ssl_ctx)
+    {
+        delegate_->OnNewSslCtx(ssl_ctx);
+    }
+
+    void ServerProofSource::GetProof(const quic::QuicSocketAddress &server_address,
+                                     const quic::QuicSocketAddress &client_address,
+                                     const std::string &hostname,
+                                     const std::string &server_config,
+                                     quic::QuicTransportVersion transport_version,
+                                     absl::string_view chlo_hash,
+                                     std::unique_ptr<Callback> callback)
+    {
+        delegate_->GetProof(server_address, client_address, hostname, server_config,
+                            transport_version, chlo_hash, std::move(callback));
+    }
+
+    quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain>
+    ServerProofSource::GetCertChain(const quic::QuicSocketAddress &server_address,
+                                    const quic::QuicSocketAddress &client_address,
+                                    const std::string &hostname, bool *cert_matched_sni)
+    {
+        return delegate_->GetCertChain(server_address, client_address, hostname,
+                                       cert_matched_sni);
+    }
+
+    void ServerProofSource::ComputeTlsSignature(
+        const quic::QuicSocketAddress &server_address,
+        const quic::QuicSocketAddress &client_address, const std::string &hostname,
+        uint16_t signature_algorithm, absl::string_view in,
+        std::unique_ptr<SignatureCallback> callback)
+    {
+        if (!signing_pool_)
+        {
+            delegate_->ComputeTlsSignature(server_address, client_address, hostname,
+                                           signature_algorithm, in, std::move(callback));
+            return;
+        }
+
+        signing_pool_->Post(
+            [this, server_address, client_address, hostname, signature_algorithm,
+             input = std::string(in)]()
+            {
+                SigningPool::Signature result;
+                delegate_->ComputeTlsSignature(
+                    server_address, client_address, hostname, signature_algorithm, input,
+                    std::make_unique<CapturingSignatureCallback>(&result));
+                return result;
+            },
+            std::move(callback));
+    }
+
+    quic::QuicSignatureAlgorithmVector ServerProofSource::SupportedTlsSignatureAlgorithms() const
+    {
+        return delegate_->SupportedTlsSignatureAlgorithms();
+    }
+
+    quic::ProofSource::TicketCrypter *ServerProofSource::GetTicketCrypter()
+    {
+        return ticket_crypter_.get();
+    }
+
+} // namespace webtransport
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/crypto/proof_source.h"
+#include "quiche/quic/core/io/quic_event_loop.h"
+#include "quiche/quic/core/quic_alarm.h"
+#include "quiche/quic/core/quic_alarm_factory.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+
+namespace webtransport
+{
+
+    // SigningPool computes TLS signatures on worker threads and completes the
+    // handshake's callback on the event loop thread, so private key operations
+    // don't hold up packet processing for established sessions.
+    class SigningPool
+    {
+    public:
+        struct Signature
+        {
+            bool ok = false;
+            std::string signature;
+        };
+
+        SigningPool(quic::QuicEventLoop *event_loop, size_t num_threads);
+        ~SigningPool();
+
+        SigningPool(const SigningPool &) = delete;
+        SigningPool &operator=(const SigningPool &) = delete;
+
+        // Runs `sign` on a worker, then `callback` with its result on the loop.
+        void Post(std::function<Signature()> sign,
+                  std::unique_ptr<quic::ProofSource::SignatureCallback> callback);
+
+    private:
+        class PollAlarmDelegate;
+
+        struct Task
+        {
+            std::function<Signature()> sign;
+            std::unique_ptr<quic::ProofSource::SignatureCallback> callback;
+        };
+
+        void WorkerLoop();
+        void DeliverResults();
+
+        const quic::QuicClock *clock_;
+        std::unique_ptr<quic::QuicAlarmFactory> alarm_factory_;
+        std::unique_ptr<quic::QuicAlarm> poll_alarm_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::deque<Task> tasks_;
+        std::vector<std::pair<Task, Signature>> results_;
+        bool stopping_ = false;
+        // Posted signatures not yet delivered; event loop thread only.
+        size_t outstanding_ = 0;
+    };
+
+    // ServerProofSource wraps the certificate ProofSource used by the server and
+    // adds the pieces ProofSourceX509 does not provide, such as a ticket crypter
+    // for stateless session resumption and signing off the event loop.
+    class ServerProofSource : public quic::ProofSource
+    {
+    public:
+        explicit ServerProofSource(std::unique_ptr<quic::ProofSource> delegate);
+        ~ServerProofSource() override = default;
+
+        // Must be called before the proof source is handed to QuicServer, since
+        // the SSL_CTX only enables tickets if a crypter exists at creation time.
+        void SetTicketCrypter(std::unique_ptr<TicketCrypter> ticket_crypter);
+
+        // Moves ComputeTlsSignature() onto `num_threads` workers whose results
+        // are delivered on `event_loop`. Until then, and with zero threads,
+        // signatures are computed inline. The delegate must sign synchronously.
+        void StartSigningPool(quic::QuicEventLoop *event_loop, size_t num_threads);
+
+        // quic::ProofSource implementation.
+        void OnNewSslCtx(SSL_CTX *ssl_ctx) override;
+        void GetProof(const quic::QuicSocketAddress &server_address,
+                      const quic::QuicSocketAddress &client_address,
+                      const std::string &hostname, const std::string &server_config,
+                      quic::QuicTransportVersion transport_version,
+                      absl::string_view chlo_hash,
+                      std::unique_ptr<Callback> callback) override;
+        quiche::QuicheReferenceCountedPointer<Chain> GetCertChain(
+            const quic::QuicSocketAddress &server_address,
+            const quic::QuicSocketAddress &client_address,
+            const std::string &hostname, bool *cert_matched_sni) override;
+        void ComputeTlsSignature(const quic::QuicSocketAddress &server_address,
+                                 const quic::QuicSocketAddress &client_address,
+                                 const std::string &hostname, uint16_t signature_algorithm,
+                                 absl::string_view in,
+                                 std::unique_ptr<SignatureCallback> callback) override;
+        quic::QuicSignatureAlgorithmVector SupportedTlsSignatureAlgorithms() const override;
+        TicketCrypter *GetTicketCrypter() override;
+
+    private:
+        std::unique_ptr<quic::ProofSource> delegate_;
+        std::unique_ptr<TicketCrypter> ticket_crypter_;
+        // Declared last so its workers stop before the delegate goes away.
+        std::unique_ptr<SigningPool> signing_pool_;
+    };
+
+} // namespace webtransport
@@ -0,0 +1,118 @@
+#include "web_transport_server_registry.h"
+
+#include <utility>
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        uint32_t SlotOf(SessionId id) { return static_cast<uint32_t>(id); }
+        uint32_t GenerationOf(SessionId id) { return static_cast<uint32_t>(id >> 32); }
+
+        SessionId MakeId(uint32_t slot, uint32_t generation)
+        {
+            return (static_cast<uint64_t>(generation) << 32) | slot;
+        }
+
+    } // namespace
+
+    std::string SessionRegistry::PathKey(absl::string_view path)
+    {
+        return std::string(path.substr(0, path.find('?')));
+    }
+
+    SessionId SessionRegistry::Add(ServerSession *session, absl::string_view path)
+    {
+        uint32_t slot_index;
+        if (!free_slots_.empty())
+        {
+            slot_index = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        else
+        {
+            slot_index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        Slot &slot = slots_[slot_index];
+        SessionId id = MakeId(slot_index, slot.generation);
+        slot.used = true;
+        slot.index = sessions_.size();
+        slot.path = PathKey(path);
+        sessions_.push_back(session);
+        ids_.push_back(id);
+
+        std::vector<SessionId> &on_path = by_path_[slot.path];
+        slot.path_index = on_path.size();
+        on_path.push_back(id);
+        return id;
+    }
+
+    void SessionRegistry::Remove(SessionId id)
+    {
+        if (Lookup(id) == nullptr)
+        {
+            return;
+        }
+        Slot &slot = slots_[SlotOf(id)];
+
+        // Move the last session into the freed position.
+        size_t index = slot.index;
+        sessions_[index] = sessions_.back();
+        ids_[index] = ids_.back();
+        slots_[SlotOf(ids_[index])].index = index;
+        sessions_.pop_back();
+        ids_.pop_back();
+
+        auto path = by_path_.find(slot.path);
+        std::vector<SessionId> &on_path = path->second;
+        on_path[slot.path_index] = on_path.back();
+        slots_[SlotOf(on_path[slot.path_index])].path_index = slot.path_index;
+        on_path.pop_back();
+        if (on_path.empty())
+        {
+            by_path_.erase(path);
+        }
+
+        slot.used = false;
+        slot.path.clear();
+        // Generation 0 would make id 0 valid; skip it on wrap-around.
+        if (++slot.generation == 0)
+        {
+            slot.generation = 1;
+        }
+        free_slots_.push_back(SlotOf(id));
+    }
+
+    const SessionRegistry::Slot *SessionRegistry::Lookup(SessionId id) const
+    {
+        uint32_t slot_index = SlotOf(id);
+        if (slot_index >= slots_.size())
+        {
+            return nullptr;
+        }
+        const Slot &slot = slots_[slot_index];
+        if (!slot.used || slot.generation != GenerationOf(id))
+        {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    ServerSession *SessionRegistry::Find(SessionId id) const
+    {
+        const Slot *slot = Lookup(id);
+        return slot ? sessions_[slot->index] : nullptr;
+    }
+
+    const std::vector<SessionId> &SessionRegistry::IdsOnPath(absl::string_view path) const
+    {
+        static const std::vector<SessionId> kNone;
+        auto it = by_path_.find(PathKey(path));
+        return it == by_path_.end() ? kNone : it->second;
+    }
+
+} // namespace webtransport
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "absl/strings/string_view.h"
+
+namespace webtransport
+{
+
+    class ServerSession;
+
+    // Identifies a session for as long as the server runs: the low 32 bits
+    // are a slot, the high 32 bits the slot's generation, so an id is never
+    // reused by a later session. 0 is never a valid id.
+    using SessionId = uint64_t;
+
+    // SessionRegistry tracks the live sessions of a server. Sessions are kept
+    // in a dense array for iteration, with O(1) lookup by id through a slot
+    // table and O(1) removal by swapping with the last entry. Sessions are
+    // also indexed by path (without the query string). Event loop thread
+    // only.
+    class SessionRegistry
+    {
+    public:
+        SessionId Add(ServerSession *session, absl::string_view path);
+        void Remove(SessionId id);
+
+        // Returns nullptr if the session has closed.
+        ServerSession *Find(SessionId id) const;
+
+        size_t size() const { return sessions_.size(); }
+        // Live sessions, in no particular order.
+        const std::vector<ServerSession *> &sessions() const { return sessions_; }
+        const std::vector<SessionId> &ids() const { return ids_; }
+        // Ids of the live sessions on `path`; the query string is ignored.
+        const std::vector<SessionId> &IdsOnPath(absl::string_view path) const;
+
+        // Visits every session. `fn` may close the session it is given;
+        // sessions closed by it otherwise may be skipped.
+        template <typename Fn>
+        void ForEach(Fn &&fn) const
+        {
+            for (size_t i = sessions_.size(); i > 0; --i)
+            {
+                if (i <= sessions_.size())
+                {
+                    fn(sessions_[i - 1]);
+                }
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            uint32_t generation = 1;
+            bool used = false;
+            // Positions in sessions_ and in the path's id list.
+            size_t index = 0;
+            size_t path_index = 0;
+            std::string path;
+        };
+
+        static std::string PathKey(absl::string_view path);
+        const Slot *Lookup(SessionId id) const;
+
+        std::vector<Slot> slots_;
+        std::vector<uint32_t> free_slots_;
+        std::vector<ServerSession *> sessions_;
+        std::vector<SessionId> ids_;
+        std::unordered_map<std::string, std::vector<SessionId>> by_path_;
+    };
+
+} // namespace webtransport
@@ -1,5 +1,7 @@
 #include "web_transport_server_session.h"
 
+#include "absl/strings/ascii.h"
+
 namespace webtransport
 {
 
@@ -8,4 +10,42 @@ namespace webtransport
     // inherits from this interface. This file is kept for consistency and potential
     // future implementations not tied to Server.
 
+    absl::string_view SessionRequest::header(absl::string_view name) const
+    {
+        // Stored lowercase, as HTTP/3 requires.
+        auto it = headers_.find(absl::AsciiStrToLower(name));
+        if (it == headers_.end())
+        {
+            return absl::string_view();
+        }
+        return it->second;
+    }
+
+    bool SessionRequest::addResponseHeader(absl::string_view name, absl::string_view value)
+    {
+        if (response_headers_ == nullptr || name.empty() || name[0] == ':')
+        {
+            return false;
+        }
+        // HTTP/3 field names must be lowercase.
+        response_headers_->AppendValueOrAddHeader(absl::AsciiStrToLower(name), value);
+        return true;
+    }
+
+    void PendingSession::accept()
+    {
+        std::call_once(decided_, [this]()
+                       { queue_->Push({id_, true, 200}); });
+    }
+
+    void PendingSession::reject(int status)
+    {
+        if (status < 400 || status > 599)
+        {
+            status = 403;
+        }
+        std::call_once(decided_, [&]()
+                       { queue_->Push({id_, false, status}); });
+    }
+
 }
\ No newline at end of file
@@ -2,33 +2,167 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
+#include "absl/strings/string_view.h"
+#include "quiche/common/http/http_header_block.h"
 #include "web_transport_server_backend.h"
 #include "web_transport_server_core.h"
+#include "web_transport_server_registry.h"
 
 
 namespace webtransport
 {
 
+    // A CONNECT request. The headers are copied: the CONNECT stream that
+    // owns them can be destroyed before the session's close callbacks run.
+    class SessionRequest
+    {
+    public:
+        explicit SessionRequest(quiche::HttpHeaderBlock headers,
+                                quiche::HttpHeaderBlock *response_headers = nullptr)
+            : headers_(std::move(headers)), response_headers_(response_headers) {}
+
+        const quiche::HttpHeaderBlock &headers() const { return headers_; }
+        // Value of header `name`, matched case-insensitively, or empty if
+        // absent. Repeated headers are joined as quiche stores them.
+        absl::string_view header(absl::string_view name) const;
+        absl::string_view path() const { return header(":path"); }
+
+        // Adds a header to the 200 response. Only possible while the request
+        // is being answered, i.e. from onSessionRequest; pseudo-headers are
+        // reserved. Returns false if the header was not added.
+        bool addResponseHeader(absl::string_view name, absl::string_view value);
+
+    private:
+        friend class Server;
+
+        // Ends the window in which response headers can be added.
+        void CloseResponse() { response_headers_ = nullptr; }
+
+        quiche::HttpHeaderBlock headers_;
+        quiche::HttpHeaderBlock *response_headers_;
+    };
+
     class ServerSession
     {
     public:
         virtual ~ServerSession() = default;
 
         virtual void SendDatagram(const std::vector<uint8_t> &data) = 0;
+        // Datagrams are framed per session, so quiche copies the payload once
+        // either way; this saves building a vector per recipient.
+        void SendDatagram(const std::shared_ptr<const std::vector<uint8_t>> &data) { SendDatagram(*data); }
 
         virtual void setInterval(uint64_t interval_ms, std::function<void()> cb) = 0;
 
         // Method to reject the session
         virtual void RejectSession(uint32_t error_code = 0, const std::string &reason = "") = 0;
 
+        // The CONNECT request that opened this session.
+        virtual const SessionRequest &request() const = 0;
+        virtual SessionId id() const = 0;
+
         using DatagramCallback = std::function<void(std::vector<uint8_t>)>;
         void onDatagramRead(DatagramCallback cb) { datagram_cb_ = std::move(cb); }
 
+        // The session was closed, by either side, with this code and reason.
+        using SessionClosedCallback = std::function<void(uint32_t error_code, const std::string &reason)>;
+        void onSessionClosed(SessionClosedCallback cb) { session_closed_cb_ = std::move(cb); }
+
+        // Called once when the session closes. Drop any pointer to it, or to
+        // its handle: both are destroyed shortly after.
+        using CloseCallback = std::function<void()>;
+        void onClose(CloseCallback cb) { close_cb_ = std::move(cb); }
+
+        // Object owned on behalf of the caller and destroyed with the session,
+        // e.g. the public API's wrapper.
+        void *handle() const { return handle_.get(); }
+        void set_handle(std::shared_ptr<void> handle) { handle_ = std::move(handle); }
+
     protected:
+        // Runs the close callback unless it already ran.
+        void NotifyClosed()
+        {
+            if (close_cb_)
+            {
+                CloseCallback cb = std::move(close_cb_);
+                close_cb_ = nullptr;
+                cb();
+            }
+        }
+
         DatagramCallback datagram_cb_;
+        SessionClosedCallback session_closed_cb_;
+        CloseCallback close_cb_;
+        std::shared_ptr<void> handle_;
+    };
+
+    // Decisions on pending sessions, handed from any thread to the event loop.
+    class SessionDecisionQueue
+    {
+    public:
+        struct Decision
+        {
+            SessionId session_id;
+            bool accept;
+            // HTTP status answering the CONNECT when rejected.
+            int status;
+        };
+
+        void Push(Decision decision)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            decisions_.push_back(std::move(decision));
+        }
+
+        std::vector<Decision> TakeAll()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<Decision> decisions;
+            decisions.swap(decisions_);
+            return decisions;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<Decision> decisions_;
+    };
+
+    // PendingSession is handed to a deferred session callback. The response
+    // to the CONNECT is held back, and the session delivers no streams or
+    // datagrams, until accept() or reject() is called. Either may be called
+    // once, from any thread; the decision is applied on the event loop
+    // shortly after. Dropping the last reference without deciding rejects
+    // the session with 403.
+    class PendingSession
+    {
+    public:
+        PendingSession(std::shared_ptr<SessionDecisionQueue> queue, SessionId id,
+                       ServerSession *session, std::string path)
+            : queue_(std::move(queue)), id_(id), session_(session), path_(std::move(path)) {}
+        ~PendingSession() { reject(403); }
+
+        // Sends the 200 and lets streams and datagrams through to the session
+        // callbacks.
+        void accept();
+        // Answers the CONNECT with `status`, which must be 4xx or 5xx; 403 is
+        // sent otherwise.
+        void reject(int status = 403);
+
+        // Only valid on the event loop thread while the session is open.
+        ServerSession *session() const { return session_; }
+        const std::string &path() const { return path_; }
+
+    private:
+        std::shared_ptr<SessionDecisionQueue> queue_;
+        SessionId id_;
+        ServerSession *session_;
+        std::string path_;
+        std::once_flag decided_;
     };
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -14,14 +15,62 @@ namespace webtransport
         virtual ~ServerStream() = default;
 
         virtual void Send(const std::vector<uint8_t> &data) = 0;
+        // Queues `data` without copying it; the stream holds a reference until
+        // the bytes are acknowledged, so one buffer can go to many streams.
+        virtual bool Send(std::shared_ptr<const std::vector<uint8_t>> data) = 0;
+        // Queues `header` and then `payload` in one write, neither copied:
+        // both are sent or, on false, neither. For framed messages, whose
+        // header must not go out without its body.
+        virtual bool Send(std::shared_ptr<const std::vector<uint8_t>> header,
+                          std::shared_ptr<const std::vector<uint8_t>> payload) = 0;
+
+        // False while quiche has buffered as much as it will take; later
+        // writes still succeed but only grow the buffer.
+        virtual bool CanWrite() const = 0;
 
         virtual void setInterval(uint64_t interval_ms, std::function<void()> cb) = 0;
 
+        // Sends a FIN after the data written so far. Returns false on
+        // streams the peer opened as unidirectional.
+        virtual bool Close() = 0;
+        // Aborts the stream in both directions with `error_code`.
+        virtual void Reset(uint64_t error_code) = 0;
+
         using DataCallback = std::function<void(std::vector<uint8_t>)>;
         void onStreamRead(DataCallback cb) { data_cb_ = std::move(cb); }
 
+        // The peer finished sending; no more data will be read. The read
+        // callbacks are released afterwards.
+        using FinCallback = std::function<void()>;
+        void onFin(FinCallback cb) { fin_cb_ = std::move(cb); }
+
+        // The peer aborted its side of the stream (RESET_STREAM), or asked
+        // us to stop sending (STOP_SENDING).
+        using ResetCallback = std::function<void(uint64_t error_code)>;
+        void onReset(ResetCallback cb) { reset_cb_ = std::move(cb); }
+        void onStopSending(ResetCallback cb) { stop_sending_cb_ = std::move(cb); }
+
+        // Called once when quiche destroys the stream. Drop any pointer to it,
+        // or to its handle, from here on.
+        using CloseCallback = std::function<void()>;
+        void onClose(CloseCallback cb) { close_cb_ = std::move(cb); }
+
+        // Object owned on behalf of the caller and destroyed with the stream,
+        // e.g. the public API's wrapper.
+        void *handle() const { return handle_.get(); }
+        void set_handle(std::shared_ptr<void> handle) { handle_ = std::move(handle); }
+
+        // Expires when the stream is destroyed, for holders of a raw pointer.
+        std::weak_ptr<const void> lifetime() const { return lifetime_; }
+
     protected:
         DataCallback data_cb_;
+        FinCallback fin_cb_;
+        ResetCallback reset_cb_;
+        ResetCallback stop_sending_cb_;
+        CloseCallback close_cb_;
+        std::shared_ptr<void> handle_;
+        std::shared_ptr<const void> lifetime_ = std::make_shared<char>(0);
     };
 
     class ServerUnidirectionalStream : public virtual ServerStream
@@ -0,0 +1,258 @@
+#include "web_transport_server_ticket.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <openssl/rand.h>
+#include "quiche/quic/core/quic_default_clock.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        constexpr size_t kNonceSize = 12;
+        constexpr size_t kTagSize = 16;
+        constexpr size_t kNonceOffset = TicketKeyProvider::kKeyNameSize;
+        constexpr size_t kMessageOffset = kNonceOffset + kNonceSize;
+
+        std::string ReadKeyFile(const std::string &path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                QUIC_LOG(ERROR) << "Failed to open ticket key file " << path;
+                return "";
+            }
+            std::stringstream ss;
+            ss << file.rdbuf();
+            return ss.str();
+        }
+
+    } // namespace
+
+    TicketKeyProvider::TicketKeyProvider(KeySource source,
+                                         quic::QuicTime::Delta rotation_interval,
+                                         const quic::QuicClock *clock)
+        : source_(std::move(source)), rotation_interval_(rotation_interval), clock_(clock) {}
+
+    TicketKeyProvider::~TicketKeyProvider()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        refresh_cv_.notify_one();
+        if (refresher_.joinable())
+        {
+            refresher_.join();
+        }
+    }
+
+    std::shared_ptr<TicketKeyProvider> TicketKeyProvider::ForFile(
+        const std::string &path, quic::QuicTime::Delta rotation_interval)
+    {
+        static std::mutex *registry_mutex = new std::mutex();
+        static auto *registry = new std::map<std::string, std::weak_ptr<TicketKeyProvider>>();
+
+        std::lock_guard<std::mutex> lock(*registry_mutex);
+        auto &entry = (*registry)[path];
+        if (auto provider = entry.lock())
+        {
+            return provider;
+        }
+        auto provider = std::make_shared<TicketKeyProvider>(
+            [path]()
+            { return ReadKeyFile(path); },
+            rotation_interval, quic::QuicDefaultClock::Get());
+        entry = provider;
+        return provider;
+    }
+
+    std::shared_ptr<TicketKeyProvider> TicketKeyProvider::Random(
+        quic::QuicTime::Delta rotation_interval)
+    {
+        // The provider calls its source on one thread at a time, so the
+        // captured state needs no locking of its own.
+        auto previous = std::make_shared<std::string>();
+        return std::make_shared<TicketKeyProvider>(
+            [previous]()
+            {
+                std::string current(kRecordSize, '\0');
+                RAND_bytes(reinterpret_cast<uint8_t *>(current.data()), current.size());
+                std::string material = current + *previous;
+                *previous = std::move(current);
+                return material;
+            },
+            rotation_interval, quic::QuicDefaultClock::Get());
+    }
+
+    std::shared_ptr<const TicketKeyProvider::KeySet> TicketKeyProvider::ParseKeys(absl::string_view material)
+    {
+        if (material.empty() || material.size() % kRecordSize != 0)
+        {
+            return nullptr;
+        }
+
+        auto key_set = std::make_shared<KeySet>();
+        for (size_t offset = 0; offset < material.size(); offset += kRecordSize)
+        {
+            const uint8_t *record = reinterpret_cast<const uint8_t *>(material.data() + offset);
+            auto key = std::make_unique<Key>();
+            std::memcpy(key->name.data(), record, kKeyNameSize);
+            if (EVP_AEAD_CTX_init(key->aead_ctx.get(), EVP_aead_aes_256_gcm(),
+                                  record + kKeyNameSize, kKeySize,
+                                  EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr) != 1)
+            {
+                return nullptr;
+            }
+            key_set->keys.push_back(std::move(key));
+        }
+        return key_set;
+    }
+
+    std::shared_ptr<const TicketKeyProvider::KeySet> TicketKeyProvider::GetKeys()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (keys_ != nullptr)
+            {
+                quic::QuicTime now = clock_->ApproximateNow();
+                if (now >= next_rotation_ && !refresh_requested_)
+                {
+                    next_rotation_ = now + rotation_interval_;
+                    refresh_requested_ = true;
+                    if (!refresher_.joinable())
+                    {
+                        refresher_ = std::thread(&TicketKeyProvider::RefreshLoop, this);
+                    }
+                    refresh_cv_.notify_one();
+                }
+                return keys_;
+            }
+        }
+
+        Reload();
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_rotation_ = clock_->ApproximateNow() + rotation_interval_;
+        return keys_;
+    }
+
+    void TicketKeyProvider::Reload()
+    {
+        std::lock_guard<std::mutex> reload_lock(reload_mutex_);
+        std::string material = source_();
+        if (!material_.empty() && material == material_)
+        {
+            return;
+        }
+        auto key_set = ParseKeys(material);
+        if (key_set == nullptr)
+        {
+            // Keep serving the previous keys rather than breaking resumption.
+            QUIC_LOG(ERROR) << "Invalid ticket key material (" << material.size()
+                            << " bytes, expected a multiple of " << kRecordSize << ")";
+            return;
+        }
+        material_ = std::move(material);
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys_ = std::move(key_set);
+    }
+
+    void TicketKeyProvider::RefreshLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            refresh_cv_.wait(lock, [this]()
+                             { return refresh_requested_ || stopping_; });
+            if (stopping_)
+            {
+                return;
+            }
+            lock.unlock();
+            Reload();
+            lock.lock();
+            refresh_requested_ = false;
+        }
+    }
+
+    SharedTicketCrypter::SharedTicketCrypter(std::shared_ptr<TicketKeyProvider> provider)
+        : provider_(std::move(provider)) {}
+
+    size_t SharedTicketCrypter::MaxOverhead()
+    {
+        return kMessageOffset + kTagSize;
+    }
+
+    std::vector<uint8_t> SharedTicketCrypter::Encrypt(absl::string_view in,
+                                                      absl::string_view /*encryption_key*/)
+    {
+        auto key_set = provider_->GetKeys();
+        if (key_set == nullptr || key_set->keys.empty())
+        {
+            return std::vector<uint8_t>();
+        }
+        const TicketKeyProvider::Key &key = *key_set->keys.front();
+
+        std::vector<uint8_t> out(in.size() + MaxOverhead());
+        std::memcpy(out.data(), key.name.data(), key.name.size());
+        RAND_bytes(out.data() + kNonceOffset, kNonceSize);
+        size_t out_len;
+        if (!EVP_AEAD_CTX_seal(key.aead_ctx.get(), out.data() + kMessageOffset, &out_len,
+                               out.size() - kMessageOffset, out.data() + kNonceOffset,
+                               kNonceSize, reinterpret_cast<const uint8_t *>(in.data()),
+                               in.size(), nullptr, 0))
+        {
+            return std::vector<uint8_t>();
+        }
+        out.resize(kMessageOffset + out_len);
+        return out;
+    }
+
+    std::vector<uint8_t> SharedTicketCrypter::Decrypt(absl::string_view in)
+    {
+        if (in.size() < kMessageOffset + kTagSize)
+        {
+            return std::vector<uint8_t>();
+        }
+        auto key_set = provider_->GetKeys();
+        if (key_set == nullptr)
+        {
+            return std::vector<uint8_t>();
+        }
+
+        const uint8_t *input = reinterpret_cast<const uint8_t *>(in.data());
+        auto it = std::find_if(key_set->keys.begin(), key_set->keys.end(),
+                               [input](const std::unique_ptr<TicketKeyProvider::Key> &key)
+                               { return std::memcmp(key->name.data(), input, key->name.size()) == 0; });
+        if (it == key_set->keys.end())
+        {
+            // Unknown or retired key; the client falls back to a full handshake.
+            return std::vector<uint8_t>();
+        }
+
+        std::vector<uint8_t> out(in.size() - kMessageOffset);
+        size_t out_len;
+        if (!EVP_AEAD_CTX_open((*it)->aead_ctx.get(), out.data(), &out_len, out.size(),
+                               input + kNonceOffset, kNonceSize, input + kMessageOffset,
+                               in.size() - kMessageOffset, nullptr, 0))
+        {
+            return std::vector<uint8_t>();
+        }
+        out.resize(out_len);
+        return out;
+    }
+
+    void SharedTicketCrypter::Decrypt(
+        absl::string_view in, std::shared_ptr<quic::ProofSource::DecryptCallback> callback)
+    {
+        callback->Run(Decrypt(in));
+    }
+
+} // namespace webtransport
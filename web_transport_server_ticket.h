@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/aead.h>
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/crypto/proof_source.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "quiche/quic/core/quic_time.h"
+
+namespace webtransport
+{
+
+    // TicketKeyProvider supplies the keys used to seal TLS session tickets.
+    //
+    // Key material is a sequence of 48-byte records: a 16-byte key name followed
+    // by a 32-byte AES-256-GCM key (`openssl rand 48` produces one record). The
+    // first record encrypts new tickets, the remaining records are only used to
+    // decrypt tickets issued before the last rotation. Servers that load the same
+    // material can resume each other's sessions, including 0-RTT.
+    class TicketKeyProvider
+    {
+    public:
+        static constexpr size_t kKeyNameSize = 16;
+        static constexpr size_t kKeySize = 32;
+        static constexpr size_t kRecordSize = kKeyNameSize + kKeySize;
+
+        // Returns the raw key material, or an empty string on failure.
+        using KeySource = std::function<std::string()>;
+
+        struct Key
+        {
+            std::array<uint8_t, kKeyNameSize> name;
+            bssl::ScopedEVP_AEAD_CTX aead_ctx;
+        };
+
+        // Immutable snapshot of the active keys. keys[0] encrypts new tickets.
+        struct KeySet
+        {
+            std::vector<std::unique_ptr<Key>> keys;
+        };
+
+        // Key material is re-read from `source` every `rotation_interval`, on
+        // a thread of the provider's own.
+        TicketKeyProvider(KeySource source, quic::QuicTime::Delta rotation_interval,
+                          const quic::QuicClock *clock);
+        ~TicketKeyProvider();
+
+        // Returns the provider for `path`. Every caller passing the same path
+        // shares one provider, and therefore one set of keys.
+        static std::shared_ptr<TicketKeyProvider> ForFile(const std::string &path,
+                                                          quic::QuicTime::Delta rotation_interval);
+
+        // Returns a provider that generates random keys in-process and rotates
+        // them every `rotation_interval`, keeping the previous key for decryption.
+        static std::shared_ptr<TicketKeyProvider> Random(quic::QuicTime::Delta rotation_interval);
+
+        // Parses key material. Returns nullptr if it is empty or malformed.
+        static std::shared_ptr<const KeySet> ParseKeys(absl::string_view material);
+
+        // Returns the current keys. Once the rotation is due the source is
+        // re-read in the background and the new keys are returned after it
+        // finishes, so a slow source never stalls a handshake. Only the first
+        // call, which has no keys to return yet, reads the source itself.
+        // Safe to call from several server threads.
+        std::shared_ptr<const KeySet> GetKeys();
+
+    private:
+        // Reads the source and swaps in the keys if they changed.
+        void Reload();
+        void RefreshLoop();
+
+        KeySource source_;
+        quic::QuicTime::Delta rotation_interval_;
+        const quic::QuicClock *clock_;
+
+        std::mutex mutex_;
+        std::shared_ptr<const KeySet> keys_;
+        quic::QuicTime next_rotation_ = quic::QuicTime::Zero();
+        bool refresh_requested_ = false;
+        bool stopping_ = false;
+        std::condition_variable refresh_cv_;
+        // Started at the first rotation.
+        std::thread refresher_;
+
+        // Serializes calls of source_; guards material_.
+        std::mutex reload_mutex_;
+        std::string material_;
+    };
+
+    // TicketCrypter backed by a (possibly shared) TicketKeyProvider.
+    //
+    // Ticket layout: key name (16) | nonce (12) | ciphertext | tag (16).
+    class SharedTicketCrypter : public quic::ProofSource::TicketCrypter
+    {
+    public:
+        explicit SharedTicketCrypter(std::shared_ptr<TicketKeyProvider> provider);
+
+        size_t MaxOverhead() override;
+        std::vector<uint8_t> Encrypt(absl::string_view in,
+                                     absl::string_view encryption_key) override;
+        void Decrypt(absl::string_view in,
+                     std::shared_ptr<quic::ProofSource::DecryptCallback> callback) override;
+
+    private:
+        std::vector<uint8_t> Decrypt(absl::string_view in);
+
+        std::shared_ptr<TicketKeyProvider> provider_;
+    };
+
+} // namespace webtransport
@@ -0,0 +1,394 @@
+#include "web_transport_server_topics.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include "absl/strings/str_cat.h"
+#include "web_transport_server_session.h"
+
+namespace webtransport
+{
+
+    namespace
+    {
+
+        // Between scans for subscribers whose session is gone but whose
+        // topics have been quiet.
+        constexpr int64_t kSweepIntervalMs = 1000;
+
+        void SendLine(ServerStream *stream, const std::string &line)
+        {
+            std::vector<uint8_t> bytes(line.begin(), line.end());
+            bytes.push_back('\n');
+            stream->Send(bytes);
+        }
+
+        // Drops `session` from `topic` in `snapshot`, and the topic with it if
+        // nobody is left.
+        void RemoveFromTopic(TopicIndex::Snapshot *snapshot, const std::string &topic, SessionId session)
+        {
+            auto it = snapshot->find(topic);
+            if (it == snapshot->end())
+            {
+                return;
+            }
+            auto subscribers = std::make_shared<TopicIndex::SubscriberList>();
+            subscribers->reserve(it->second->size());
+            for (const TopicSubscriber &subscriber : *it->second)
+            {
+                if (subscriber.session != session)
+                {
+                    subscribers->push_back(subscriber);
+                }
+            }
+            if (subscribers->empty())
+            {
+                snapshot->erase(it);
+            }
+            else
+            {
+                it->second = std::move(subscribers);
+            }
+        }
+
+    } // namespace
+
+    TopicIndex::TopicIndex() : latest_(std::make_shared<const Snapshot>())
+    {
+        slots_[0].snapshot = latest_;
+    }
+
+    std::shared_ptr<const TopicIndex::Snapshot> TopicIndex::Load() const
+    {
+        while (true)
+        {
+            uint32_t index = current_.load();
+            const Slot &slot = slots_[index];
+            slot.readers.fetch_add(1);
+            // The slot stays current while pinned: writers only fill the
+            // other one, and wait for its readers to leave before doing so.
+            if (current_.load() == index)
+            {
+                std::shared_ptr<const Snapshot> snapshot = slot.snapshot;
+                slot.readers.fetch_sub(1);
+                return snapshot;
+            }
+            slot.readers.fetch_sub(1);
+        }
+    }
+
+    std::shared_ptr<const TopicIndex::SubscriberList> TopicIndex::Find(absl::string_view topic) const
+    {
+        std::shared_ptr<const Snapshot> snapshot = Load();
+        auto it = snapshot->find(topic);
+        return it == snapshot->end() ? nullptr : it->second;
+    }
+
+    void TopicIndex::Publish(std::shared_ptr<const Snapshot> snapshot)
+    {
+        latest_ = snapshot;
+        uint32_t next = 1 - current_.load();
+        Slot &slot = slots_[next];
+        // Only readers that pinned the slot before the last switch, and are
+        // about to retry, can be here.
+        while (slot.readers.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        slot.snapshot = std::move(snapshot);
+        current_.store(next);
+    }
+
+    bool TopicIndex::Subscribe(const std::string &topic, const TopicSubscriber &subscriber)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::vector<std::string> &topics = topics_by_session_[subscriber.session];
+        if (std::find(topics.begin(), topics.end(), topic) != topics.end())
+        {
+            return false;
+        }
+        topics.push_back(topic);
+
+        auto snapshot = std::make_shared<Snapshot>(*latest_);
+        auto subscribers = std::make_shared<SubscriberList>();
+        auto it = snapshot->find(topic);
+        if (it != snapshot->end())
+        {
+            subscribers->reserve(it->second->size() + 1);
+            *subscribers = *it->second;
+        }
+        subscribers->push_back(subscriber);
+        (*snapshot)[topic] = std::move(subscribers);
+        Publish(std::move(snapshot));
+        return true;
+    }
+
+    bool TopicIndex::Unsubscribe(const std::string &topic, SessionId session)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        auto session_topics = topics_by_session_.find(session);
+        if (session_topics == topics_by_session_.end())
+        {
+            return false;
+        }
+        std::vector<std::string> &topics = session_topics->second;
+        auto it = std::find(topics.begin(), topics.end(), topic);
+        if (it == topics.end())
+        {
+            return false;
+        }
+        *it = std::move(topics.back());
+        topics.pop_back();
+        if (topics.empty())
+        {
+            topics_by_session_.erase(session_topics);
+        }
+
+        auto snapshot = std::make_shared<Snapshot>(*latest_);
+        RemoveFromTopic(snapshot.get(), topic, session);
+        Publish(std::move(snapshot));
+        return true;
+    }
+
+    void TopicIndex::RemoveSession(SessionId session)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        auto session_topics = topics_by_session_.find(session);
+        if (session_topics == topics_by_session_.end())
+        {
+            return;
+        }
+        auto snapshot = std::make_shared<Snapshot>(*latest_);
+        for (const std::string &topic : session_topics->second)
+        {
+            RemoveFromTopic(snapshot.get(), topic, session);
+        }
+        topics_by_session_.erase(session_topics);
+        Publish(std::move(snapshot));
+    }
+
+    size_t TopicIndex::SubscriptionCount(SessionId session) const
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        auto it = topics_by_session_.find(session);
+        return it == topics_by_session_.end() ? 0 : it->second.size();
+    }
+
+    std::vector<SessionId> TopicIndex::Sessions() const
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::vector<SessionId> sessions;
+        sessions.reserve(topics_by_session_.size());
+        for (const auto &entry : topics_by_session_)
+        {
+            sessions.push_back(entry.first);
+        }
+        return sessions;
+    }
+
+    TopicRouter::TopicRouter(const SessionRegistry *sessions, Broadcaster *broadcaster)
+        : sessions_(sessions), broadcaster_(broadcaster)
+    {
+        broadcaster_->AddTickTask(this);
+    }
+
+    TopicRouter::~TopicRouter()
+    {
+        broadcaster_->RemoveTickTask(this);
+    }
+
+    void TopicRouter::AttachControlStream(SessionId session, ServerStream *stream)
+    {
+        // Holds a partial command between reads. The callbacks belong to the
+        // stream, so capturing it is safe.
+        auto buffered = std::make_shared<std::string>();
+        stream->onStreamRead(
+            [this, session, stream, buffered](std::vector<uint8_t> data)
+            {
+                buffered->append(reinterpret_cast<const char *>(data.data()), data.size());
+                size_t start = 0;
+                size_t end;
+                while ((end = buffered->find('\n', start)) != std::string::npos)
+                {
+                    absl::string_view line(buffered->data() + start, end - start);
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.remove_suffix(1);
+                    }
+                    HandleCommand(session, stream, line);
+                    start = end + 1;
+                }
+                buffered->erase(0, start);
+                // Longer than any valid command.
+                if (buffered->size() > config_.max_topic_length + 8)
+                {
+                    buffered->clear();
+                    SendLine(stream, "ERR ? line-too-long");
+                }
+            });
+        stream->onFin(
+            [this, session, stream]()
+            {
+                index_.RemoveSession(session);
+                stream->Close();
+            });
+    }
+
+    void TopicRouter::HandleCommand(SessionId session, ServerStream *stream, absl::string_view line)
+    {
+        size_t space = line.find(' ');
+        absl::string_view command = line.substr(0, space);
+        absl::string_view topic = space == absl::string_view::npos ? absl::string_view() : line.substr(space + 1);
+        if (command.empty())
+        {
+            return;
+        }
+
+        if (command == "SUB")
+        {
+            if (topic.empty() || topic.size() > config_.max_topic_length)
+            {
+                SendLine(stream, "ERR SUB invalid-topic");
+                return;
+            }
+            if (config_.max_subscriptions_per_session > 0 &&
+                index_.SubscriptionCount(session) >= config_.max_subscriptions_per_session)
+            {
+                SendLine(stream, "ERR SUB too-many-subscriptions");
+                return;
+            }
+            TopicSubscriber subscriber;
+            subscriber.session = session;
+            subscriber.stream = stream;
+            subscriber.stream_lifetime = stream->lifetime();
+            if (index_.Subscribe(std::string(topic), subscriber))
+            {
+                broadcaster_->Activate();
+            }
+            SendLine(stream, absl::StrCat("OK SUB ", topic));
+        }
+        else if (command == "UNSUB")
+        {
+            index_.Unsubscribe(std::string(topic), session);
+            SendLine(stream, absl::StrCat("OK UNSUB ", topic));
+        }
+        else
+        {
+            SendLine(stream, absl::StrCat("ERR ", command, " unknown-command"));
+        }
+    }
+
+    bool TopicRouter::Publish(absl::string_view topic, Payload payload)
+    {
+        if (!payload)
+        {
+            return false;
+        }
+        std::shared_ptr<const TopicIndex::SubscriberList> subscribers = index_.Find(topic);
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            ++stats_.published;
+            if (!subscribers)
+            {
+                ++stats_.unrouted;
+            }
+        }
+        if (!subscribers)
+        {
+            return false;
+        }
+
+        std::string header = absl::StrCat("MSG ", topic, " ", payload->size(), "\n");
+        Message message;
+        message.subscribers = std::move(subscribers);
+        message.header = std::make_shared<const std::vector<uint8_t>>(header.begin(), header.end());
+        message.payload = std::move(payload);
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_.push_back(std::move(message));
+        }
+        broadcaster_->Wake();
+        return true;
+    }
+
+    size_t TopicRouter::SubscriberCount(absl::string_view topic) const
+    {
+        std::shared_ptr<const TopicIndex::SubscriberList> subscribers = index_.Find(topic);
+        return subscribers ? subscribers->size() : 0;
+    }
+
+    TopicStats TopicRouter::stats() const
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return stats_;
+    }
+
+    bool TopicRouter::OnTick(quic::QuicTime now)
+    {
+        std::vector<Message> messages;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            messages.swap(pending_);
+        }
+
+        if (!messages.empty())
+        {
+            std::vector<SessionId> gone;
+            for (const Message &message : messages)
+            {
+                Deliver(message, &gone);
+            }
+            std::sort(gone.begin(), gone.end());
+            gone.erase(std::unique(gone.begin(), gone.end()), gone.end());
+            for (SessionId session : gone)
+            {
+                index_.RemoveSession(session);
+            }
+        }
+
+        if (now - last_sweep_ >= quic::QuicTime::Delta::FromMilliseconds(kSweepIntervalMs))
+        {
+            last_sweep_ = now;
+            Sweep();
+        }
+        return !index_.Load()->empty();
+    }
+
+    void TopicRouter::Deliver(const Message &message, std::vector<SessionId> *gone)
+    {
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        for (const TopicSubscriber &subscriber : *message.subscribers)
+        {
+            if (subscriber.stream_lifetime.expired() || sessions_->Find(subscriber.session) == nullptr)
+            {
+                gone->push_back(subscriber.session);
+                continue;
+            }
+            // The header must not go out without its payload.
+            if (!subscriber.stream->CanWrite() ||
+                !subscriber.stream->Send(message.header, message.payload))
+            {
+                ++dropped;
+                continue;
+            }
+            ++delivered;
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.delivered += delivered;
+        stats_.dropped += dropped;
+    }
+
+    void TopicRouter::Sweep()
+    {
+        for (SessionId session : index_.Sessions())
+        {
+            if (sessions_->Find(session) == nullptr)
+            {
+                index_.RemoveSession(session);
+            }
+        }
+    }
+
+} // namespace webtransport
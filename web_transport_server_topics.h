@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_time.h"
+#include "web_transport_server_channel.h"
+#include "web_transport_server_registry.h"
+#include "web_transport_server_stream.h"
+
+namespace webtransport
+{
+
+    // A session subscribed to a topic, reached through the control stream it
+    // subscribed on.
+    struct TopicSubscriber
+    {
+        SessionId session = 0;
+        ServerStream *stream = nullptr;
+        std::weak_ptr<const void> stream_lifetime;
+    };
+
+    // TopicIndex maps topic names to their subscribers. Changes are made on
+    // one thread at a time and publish a new immutable snapshot; Find() and
+    // Load() never take a lock, so any number of threads can route messages
+    // while subscriptions change. A change copies the topic's subscriber
+    // vector and the table of topic pointers, not the other topics' vectors.
+    class TopicIndex
+    {
+    public:
+        using SubscriberList = std::vector<TopicSubscriber>;
+        using Snapshot = absl::flat_hash_map<std::string, std::shared_ptr<const SubscriberList>>;
+
+        TopicIndex();
+
+        // Any thread, lock-free.
+        std::shared_ptr<const Snapshot> Load() const;
+        std::shared_ptr<const SubscriberList> Find(absl::string_view topic) const;
+
+        // Writers; serialized internally. Return false if nothing changed.
+        bool Subscribe(const std::string &topic, const TopicSubscriber &subscriber);
+        bool Unsubscribe(const std::string &topic, SessionId session);
+        void RemoveSession(SessionId session);
+
+        // Topics `session` is subscribed to.
+        size_t SubscriptionCount(SessionId session) const;
+        // Sessions with at least one subscription.
+        std::vector<SessionId> Sessions() const;
+
+    private:
+        // Two snapshot slots. Readers pin the current slot with a counter;
+        // a writer fills the other one, once its last reader has left, and
+        // then makes it current.
+        struct Slot
+        {
+            mutable std::atomic<uint32_t> readers{0};
+            std::shared_ptr<const Snapshot> snapshot;
+        };
+
+        // Called with writer_mutex_ held.
+        void Publish(std::shared_ptr<const Snapshot> snapshot);
+
+        Slot slots_[2];
+        std::atomic<uint32_t> current_{0};
+
+        mutable std::mutex writer_mutex_;
+        // Writer-side copy of the current snapshot, and each session's topics.
+        std::shared_ptr<const Snapshot> latest_;
+        std::unordered_map<SessionId, std::vector<std::string>> topics_by_session_;
+    };
+
+    struct TopicConfig
+    {
+        size_t max_topic_length = 256;
+        size_t max_subscriptions_per_session = 64;
+    };
+
+    struct TopicStats
+    {
+        uint64_t published = 0;
+        // Published to a topic nobody was subscribed to.
+        uint64_t unrouted = 0;
+        uint64_t delivered = 0;
+        // Not written because the control stream was blocked or refused the
+        // write.
+        uint64_t dropped = 0;
+    };
+
+    // TopicRouter runs a small publish/subscribe protocol on bidirectional
+    // control streams. The client sends newline-terminated commands:
+    //
+    //   SUB <topic>      UNSUB <topic>
+    //
+    // and the server answers "OK <command> <topic>" or "ERR <command>
+    // <reason>", and delivers each message on the stream as
+    //
+    //   MSG <topic> <length>\n<length bytes>
+    //
+    // Publish() may be called from any thread; messages are written on the
+    // event loop thread, on the broadcaster's next tick. The message header
+    // is built once and the payload is shared by every subscriber.
+    class TopicRouter : private TickTask
+    {
+    public:
+        using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+        // `broadcaster` must outlive the router.
+        TopicRouter(const SessionRegistry *sessions, Broadcaster *broadcaster);
+        ~TopicRouter() override;
+
+        void set_config(const TopicConfig &config) { config_ = config; }
+
+        // Takes over reading `stream` as the session's control stream. Event
+        // loop thread only.
+        void AttachControlStream(SessionId session, ServerStream *stream);
+
+        // Any thread. Returns false, without queueing anything, if the topic
+        // has no subscribers.
+        bool Publish(absl::string_view topic, Payload payload);
+        size_t SubscriberCount(absl::string_view topic) const;
+
+        const TopicIndex &index() const { return index_; }
+        TopicStats stats() const;
+
+    private:
+        struct Message
+        {
+            std::shared_ptr<const TopicIndex::SubscriberList> subscribers;
+            Payload header;
+            Payload payload;
+        };
+
+        void HandleCommand(SessionId session, ServerStream *stream, absl::string_view line);
+        bool OnTick(quic::QuicTime now) override;
+        void Deliver(const Message &message, std::vector<SessionId> *gone);
+        void Sweep();
+
+        const SessionRegistry *sessions_;
+        Broadcaster *broadcaster_;
+        TopicConfig config_;
+        TopicIndex index_;
+
+        std::mutex pending_mutex_;
+        std::vector<Message> pending_;
+
+        mutable std::mutex stats_mutex_;
+        TopicStats stats_;
+
+        quic::QuicTime last_sweep_ = quic::QuicTime::Zero();
+    };
+
+} // namespace webtransport